@@ -0,0 +1,53 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** asset_loader.hpp
+*/
+
+#ifndef ASSET_LOADER_HPP
+#define ASSET_LOADER_HPP
+
+#include "common.hpp"
+#include <functional>
+
+// Small worker pool for decoding assets off the render thread. decode runs
+// on a worker; finish runs on the thread calling poll(), which is where
+// anything touching the GL context (texture uploads) has to happen.
+class AssetLoader {
+public:
+    using Decode = std::function<bool()>;
+    using Finish = std::function<void()>;
+
+    AssetLoader() = default;
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+    ~AssetLoader();
+
+    void submit(const std::string& name, Decode decode, Finish finish);
+    void start(int workerCount);
+    void stop();
+    int poll();
+    bool isDone() const { return finished == jobs.size(); }
+
+private:
+    struct Job {
+        std::string name;
+        Decode decode;
+        Finish finish;
+        bool ok = false;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextJob{0};
+    std::atomic<bool> stopping{false};
+    std::mutex readyMutex;
+    std::vector<size_t> ready;
+    std::vector<size_t> readyLocal;
+    size_t finished = 0;
+
+    void workerLoop();
+};
+
+#endif /* ASSET_LOADER_HPP */
@@ -0,0 +1,43 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** asset_pack.hpp
+*/
+
+#ifndef ASSET_PACK_HPP
+#define ASSET_PACK_HPP
+
+#include "common.hpp"
+
+// Pack layout (little-endian): "JPAK", u32 version, u32 entry count, then per
+// entry u32 name length, name, u64 offset, u64 size. File contents follow,
+// each aligned to 16 bytes, and are used in place from the mapping.
+struct AssetEntry {
+    std::string name;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+class AssetPack {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    AssetPack() = default;
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    ~AssetPack();
+
+    bool open(const std::string& filename);
+    const AssetEntry* find(const std::string& name) const;
+    const std::vector<AssetEntry>& getEntries() const { return entries; }
+
+    static bool write(const std::string& filename, const std::vector<std::string>& files);
+
+private:
+    const uint8_t* mapping = nullptr;
+    size_t mappingSize = 0;
+    std::vector<AssetEntry> entries;
+};
+
+#endif /* ASSET_PACK_HPP */
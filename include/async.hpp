@@ -0,0 +1,251 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** async.hpp
+*/
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include "common.hpp"
+#include "protocol.hpp"
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+template <typename T>
+struct TaskResult {
+    std::optional<T> value;
+
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(*value); }
+};
+
+template <>
+struct TaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+// A coroutine that starts suspended and runs when it is first awaited (or
+// spawned on an EventLoop). When it finishes it resumes whoever awaited it,
+// without going back through the loop.
+template <typename T = void>
+class Task {
+public:
+    struct promise_type : TaskResult<T> {
+        std::coroutine_handle<> continuation;
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                std::coroutine_handle<> next = handle.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        // Nothing up the chain could handle it: the loop has no caller to
+        // report to, so fail loudly rather than leave a session half done.
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept : coroutine(std::exchange(other.coroutine, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (coroutine) {
+                coroutine.destroy();
+            }
+            coroutine = std::exchange(other.coroutine, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    bool done() const { return !coroutine || coroutine.done(); }
+    std::coroutine_handle<> handle() const { return coroutine; }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        coroutine.promise().continuation = caller;
+        return coroutine;
+    }
+    T await_resume() { return coroutine.promise().take(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+    std::coroutine_handle<promise_type> coroutine;
+};
+
+// A single-threaded executor: epoll for socket readiness plus a timer heap.
+// Coroutines park themselves on a descriptor or a deadline and the loop
+// resumes them from runUntil(); nothing here blocks except the epoll_wait.
+// A parked coroutine is only ever destroyed by the loop itself, on exit.
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct FdAwaiter {
+        EventLoop& loop;
+        int fd;
+        bool write;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.park(fd, write, handle); }
+        void await_resume() const noexcept {}
+    };
+
+    struct TimerAwaiter {
+        EventLoop& loop;
+        Clock::time_point deadline;
+
+        bool await_ready() const noexcept { return Clock::now() >= deadline; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.schedule(deadline, handle); }
+        void await_resume() const noexcept {}
+    };
+
+    EventLoop() = default;
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+    ~EventLoop();
+
+    bool open();
+    // Takes ownership of a top-level coroutine and starts it on the next
+    // turn of the loop. It is freed once it has finished.
+    void spawn(Task<> task);
+    // Runs until the deadline passes or stop() is called. False if epoll fails.
+    bool runUntil(Clock::time_point deadline);
+    // For a loop driven from someone else's poll, which watches descriptor():
+    // resumes whatever can run now and returns without waiting. Timers
+    // only fire if they are already due.
+    bool runReady();
+    void stop() { stopped = true; }
+    size_t taskCount() const { return tasks.size(); }
+    int descriptor() const { return epollFd; }
+    // Resumes handle on the next turn of the loop.
+    void post(std::coroutine_handle<> handle) { ready.push_back(handle); }
+
+    // Descriptors are watched edge-triggered: await readable()/writable()
+    // only after the call that needed them has returned EAGAIN.
+    bool add(int fd);
+    // Stops watching fd and wakes whoever was parked on it, so they can see
+    // that it is gone. Must be called before fd is closed.
+    void remove(int fd);
+
+    FdAwaiter readable(int fd) { return {*this, fd, false}; }
+    FdAwaiter writable(int fd) { return {*this, fd, true}; }
+    TimerAwaiter sleepUntil(Clock::time_point deadline) { return {*this, deadline}; }
+
+private:
+    struct Waiters {
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+    };
+
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t sequence;
+        std::coroutine_handle<> handle;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    int epollFd = -1;
+    bool stopped = false;
+    uint64_t nextSequence = 0;
+    size_t finishedTasks = 0;
+    std::vector<Task<>> tasks;
+    std::vector<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> resuming;
+    std::unordered_map<int, Waiters> waiters;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+
+    void park(int fd, bool write, std::coroutine_handle<> handle);
+    void schedule(Clock::time_point deadline, std::coroutine_handle<> handle);
+    void resumeReady();
+    void expireTimers(Clock::time_point now);
+    int pollEvents(int timeoutMs);
+    void reapTasks();
+    Task<> supervise(Task<> task);
+};
+
+// One framed connection driven by an EventLoop. Reads and writes look
+// sequential to the coroutine awaiting them: each suspends only while the
+// socket would block. The session owns its descriptor.
+class AsyncSession {
+public:
+    // A received packet. data stays valid until the next readFrame().
+    struct Frame {
+        int type = 0;
+        const char* data = nullptr;
+        int length = 0;
+    };
+
+    explicit AsyncSession(EventLoop& loop);
+    AsyncSession(const AsyncSession&) = delete;
+    AsyncSession& operator=(const AsyncSession&) = delete;
+    ~AsyncSession();
+
+    // Takes over an already connected socket, which is made non-blocking.
+    bool adopt(int socket);
+    // Hands the socket back to the caller, still open and non-blocking.
+    // Bytes already read past the last frame go to unread, for whoever
+    // reads the socket next; that frame stays readable until then.
+    int release(std::vector<char>& unread);
+    Task<bool> connect(const struct sockaddr* address, socklen_t length);
+    // False once the peer has hung up, sent a malformed header or the
+    // session was closed.
+    Task<bool> readFrame(Frame& frame);
+    // Queues the packet and returns once it has been handed to the kernel.
+    // A write issued while another is still waiting for the socket queues
+    // behind it and returns once that flush has sent both, in order.
+    Task<bool> write(int packetType, const void* data = nullptr, int length = 0);
+    Task<bool> write(const SharedPacket& packet);
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    int descriptor() const { return fd; }
+
+private:
+    EventLoop& loop;
+    int fd = -1;
+    std::vector<char> input;
+    size_t inputStart = 0;
+    size_t inputEnd = 0;
+    size_t consumed = 0;
+    std::vector<char> output;
+    size_t outputSent = 0;
+    bool flushing = false;
+    // Writers parked behind the flush in progress.
+    std::vector<std::coroutine_handle<>> flushWaiters;
+
+    struct FlushAwaiter {
+        AsyncSession& session;
+
+        bool await_ready() const noexcept { return !session.flushing; }
+        void await_suspend(std::coroutine_handle<> handle) { session.flushWaiters.push_back(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    bool extractFrame(Frame& frame, bool& malformed);
+    Task<bool> flush();
+};
+
+#endif /* ASYNC_HPP */
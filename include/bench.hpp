@@ -0,0 +1,58 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** bench.hpp
+*/
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "common.hpp"
+#include <functional>
+
+struct BenchResult {
+    std::string name;
+    int64_t size = 0;
+    uint64_t iterations = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+};
+
+// Runs each benchmark body with a growing iteration count until one batch
+// takes at least minTimeMs, then keeps the fastest of a few batches of that
+// size. Heap allocations are counted by the replaced global operator new.
+class BenchRunner {
+public:
+    using Body = std::function<void(uint64_t iterations)>;
+    // Returns what went wrong, or an empty string.
+    using Check = std::function<std::string()>;
+
+    void setMinTimeMs(int ms) { minTimeMs = ms; }
+    void setFilter(const std::string& value) { filter = value; }
+
+    void run(const std::string& name, int64_t size, const Body& body);
+    // Runs body once and records a failure if it allocated at all: for
+    // paths that must stay off the heap once warmed up.
+    void expectNoAllocations(const std::string& name, uint64_t iterations, const Body& body);
+    // Runs a correctness check once and records a failure if it reports one.
+    void check(const std::string& name, const Check& body);
+    bool passed() const { return failures == 0; }
+    const std::vector<BenchResult>& getResults() const { return results; }
+    bool writeJson(const std::string& filename) const;
+
+private:
+    int minTimeMs = 200;
+    std::string filter;
+    std::vector<BenchResult> results;
+    int failures = 0;
+};
+
+// Keeps the compiler from discarding a value computed only for timing.
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif /* BENCH_HPP */
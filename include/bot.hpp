@@ -0,0 +1,55 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** bot.hpp
+*/
+
+#ifndef BOT_HPP
+#define BOT_HPP
+
+#include "common.hpp"
+#include "session.hpp"
+#include <random>
+
+struct BotStep {
+    int ticks;
+    bool jetpackOn;
+};
+
+struct BotOutcome {
+    bool finished = false;
+    int playerId = -1;
+    int winnerId = -1;
+    int score = 0;
+    int ticksAlive = 0;
+    int jetpackToggles = 0;
+    double durationSeconds = 0.0;
+};
+
+class Bot {
+public:
+    Bot(const std::string& serverIP, int port);
+
+    bool loadScript(const std::string& filename);
+    void setRandomPolicy(unsigned int seed, float toggleChance);
+    void setSkillRating(int rating) { session.setSkillRating(rating); }
+    bool run();
+    const BotOutcome& getOutcome() const { return outcome; }
+    bool writeOutcome(const std::string& filename) const;
+
+private:
+    ClientSession session;
+    std::vector<BotStep> script;
+    size_t scriptIndex = 0;
+    int stepTicksLeft = 0;
+    std::mt19937 rng;
+    float toggleChance = 0.05f;
+    bool jetpackOn = false;
+    BotOutcome outcome;
+
+    bool nextInput();
+    void recordOutcome();
+};
+
+#endif /* BOT_HPP */
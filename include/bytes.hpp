@@ -0,0 +1,107 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** bytes.hpp
+*/
+
+#ifndef BYTES_HPP
+#define BYTES_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Little-endian encoding helpers for the on-disk formats.
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void u8(uint8_t value) { out.push_back(value); }
+    void u16(uint16_t value) { put(value, 2); }
+    void u32(uint32_t value) { put(value, 4); }
+    void u64(uint64_t value) { put(value, 8); }
+    void i32(int32_t value) { put(static_cast<uint32_t>(value), 4); }
+    void f32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        put(bits, 4);
+    }
+    void bytes(const void* data, size_t size) {
+        const uint8_t* begin = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), begin, begin + size);
+    }
+
+private:
+    void put(uint64_t value, int size) {
+        for (int i = 0; i < size; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    std::vector<uint8_t>& out;
+};
+
+// Reads what ByteWriter wrote; any read past the end clears ok() and
+// returns zero, so callers check ok() once after a batch of reads.
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return valid; }
+    size_t position() const { return pos; }
+    size_t remaining() const { return size - pos; }
+
+    uint8_t u8() { return static_cast<uint8_t>(get(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(get(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(get(4)); }
+    uint64_t u64() { return get(8); }
+    int32_t i32() { return static_cast<int32_t>(get(4)); }
+    float f32() {
+        uint32_t bits = static_cast<uint32_t>(get(4));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    const uint8_t* bytes(size_t count) {
+        if (!valid || count > size - pos) {
+            valid = false;
+            return nullptr;
+        }
+        const uint8_t* result = data + pos;
+        pos += count;
+        return result;
+    }
+
+private:
+    uint64_t get(int count) {
+        if (!valid || static_cast<size_t>(count) > size - pos) {
+            valid = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (int i = 0; i < count; i++) {
+            value |= static_cast<uint64_t>(data[pos + i]) << (8 * i);
+        }
+        pos += count;
+        return value;
+    }
+
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    bool valid = true;
+};
+
+inline uint64_t fnv1a64(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#endif /* BYTES_HPP */
@@ -8,14 +8,52 @@
 #ifndef CLIENT_HPP
 #define CLIENT_HPP
 
+#include "asset_loader.hpp"
+#include "asset_pack.hpp"
 #include "common.hpp"
 #include "map.hpp"
+#include "profiler.hpp"
 #include "protocol.hpp"
+#include "session.hpp"
+#include "sound_pool.hpp"
+#include "triple_buffer.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <SFML/System.hpp>
 #include <SFML/Audio.hpp>
-#include <map>
+
+#define ASSET_PACK_FILE "assets.pack"
+
+enum FramePacing {
+    PACING_VSYNC = 0,
+    PACING_LIMIT,
+    PACING_UNCAPPED
+};
+
+enum TextureId {
+    TEXTURE_BACKGROUND = 0,
+    TEXTURE_PLAYER,
+    TEXTURE_COINS,
+    TEXTURE_ZAPPER,
+    TEXTURE_COUNT
+};
+
+// Everything the render thread needs for one simulation tick. The input
+// thread fills one per tick; the render thread blends the previous and
+// current positions by how far it is into the following tick.
+struct RenderFrame {
+    ClientSnapshot snapshot;
+    float previousCameraX = 0.0f;
+    float cameraX = 0.0f;
+    std::array<Vector2, MAX_PLAYERS> previousPositions;
+    std::array<Vector2, MAX_PLAYERS> currentPositions;
+    bool jetpackActive = false;
+    bool showOverlay = false;
+    int playerFrame = 0;
+    int coinFrame = 0;
+    int zapperFrame = 0;
+    int64_t publishedNs = 0;
+};
 
 class Client {
 public:
@@ -28,48 +66,66 @@ public:
     bool isRunning() const { return running; }
     void sendPlayerPosition(bool jetpackOn);
     void updateCamera(float deltaTime);
+    void setTraceFile(const std::string& filename);
+    void setSpectator(bool enabled);
+    void setFramePacing(FramePacing mode, int framesPerSecond);
 
 private:
-    std::string serverIP;
-    int port;
-    int clientSocket = -1;
-    Map gameMap;
-    std::array<Player, MAX_PLAYERS> players;
-    int myPlayerId = -1;
-    GameState gameState = WAITING;
     std::atomic<bool> running{false};
-    
+
+    ClientSession session;
+    TripleBuffer<ClientSnapshot> frames;
+    const ClientSnapshot* frame = nullptr;
+    TripleBuffer<RenderFrame> renderFrames;
+    const RenderFrame* view = nullptr;
+
     std::thread networkThread;
     std::thread graphicsThread;
-    std::mutex gameMutex;
     
     sf::RenderWindow window;
     sf::Font font;
-    std::map<std::string, sf::Texture> textures;
-    std::map<std::string, sf::Sprite> sprites;
+    AssetPack assetPack;
+    std::array<sf::Image, TEXTURE_COUNT> images;
+    std::array<sf::Texture, TEXTURE_COUNT> textures;
+    std::array<sf::Sprite, TEXTURE_COUNT> sprites;
+    std::array<bool, TEXTURE_COUNT> textureReady{};
     
     int currentPlayerFrame = 0;
     int currentCoinFrame = 0;
     int currentZapperFrame = 0;
+    int animationTicks = 0;
     float cameraX = 0.0f;
-    sf::Clock animationClock;
+    float previousCameraX = 0.0f;
+    float renderCameraX = 0.0f;
+    std::array<Vector2, MAX_PLAYERS> previousPositions;
+    std::array<Vector2, MAX_PLAYERS> currentPositions;
+    std::array<Vector2, MAX_PLAYERS> renderPositions;
+    FramePacing framePacing = PACING_LIMIT;
+    int targetFps = 60;
     
+    SoundPool sounds;
     sf::Sound jetpackSound;
-    sf::Sound coinSound;
-    sf::Sound zapperSound;
     sf::Music backgroundMusic;
-    std::map<std::string, sf::SoundBuffer> soundBuffers;
+    AssetLoader assetLoader;
     
     int windowWidth = 800;
     int windowHeight = 600;
-    int waitingPlayers = 1;
     bool jetpackActive = false;
+    bool showOverlay = false;
+    std::string traceFile;
+    FrameStats overlayStats;
+    sf::Clock overlayClock;
 
     void networkLoop();
+    void inputLoop();
     void graphicsLoop();
-    void simulateLocalPlayer(float deltaTime);
-    void handleServerMessage();
+    void publishState();
+    void publishRenderFrame();
+    void fixedUpdate(float deltaTime);
+    void interpolate(float alpha);
+    void waitForNextFrame(std::chrono::steady_clock::time_point& deadline);
     void render();
+    void renderOverlay();
     
     bool loadAssets();
     void initWindow();
@@ -78,6 +134,7 @@ private:
     void renderCoin(int x, int y, int width, int height);
     void renderZapper(int x, int y, int width, int height);
     void handleInput();
+    void setJetpackSound(bool on);
 };
 
 #endif /* CLIENT_HPP */
\ No newline at end of file
@@ -20,11 +20,13 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <poll.h>
 #include <unistd.h>
 #include <cstring>
 #include <fstream>
 #include <sstream>
+#include "log.hpp"
 
 #define MAX_BUFFER_SIZE 4096
 #define MAX_PLAYERS 2
@@ -81,7 +83,4 @@ public:
     std::string name;
 };
 
-extern bool debug_mode;
-void debugPrint(const std::string& message);
-
 #endif
\ No newline at end of file
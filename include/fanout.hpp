@@ -0,0 +1,102 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** fanout.hpp
+*/
+
+#ifndef FANOUT_HPP
+#define FANOUT_HPP
+
+#include "common.hpp"
+#include "protocol.hpp"
+
+#define MAX_SPECTATOR_BACKLOG 120
+
+struct SpectatorStats {
+    std::atomic<int> connected{0};
+    std::atomic<uint64_t> dropped{0};
+    TrafficCounters traffic;
+};
+
+// A watcher that holds no player slot. Its socket is non-blocking and
+// whatever it could not take yet waits in its backlog, sized when the
+// spectator joins. A free slot has no socket.
+struct Spectator {
+    int socket = -1;
+    PacketBacklog backlog;
+    // Found gone while a flush was sending: that flush retires it.
+    bool closing = false;
+    // Its socket failed during the current flush.
+    bool failed = false;
+};
+
+// Pushes the same encoded packets to many non-blocking sockets. A slow
+// reader only costs its own queue of references; one that falls more than
+// maxBacklog packets behind, or whose socket fails, is dropped. publish()
+// only queues, under the lock add() and dropClosed() also take; flush()
+// sends without it, so the owner's thread never waits on a send. Both run
+// on whichever thread produces the stream, so they do not close what they
+// drop: the owner's thread does, in closeRetired(), at a point where it
+// holds no descriptor from appendPollFds() that could be reused meanwhile.
+// Used by the server for its spectators and by the relay for its clients.
+class FanOut {
+public:
+    FanOut(size_t maxSpectators, size_t maxBacklog, SpectatorStats& stats);
+    ~FanOut();
+
+    bool add(int socket, const std::vector<SharedPacket>& catchUp);
+    void publish(const SharedPacket& packet);
+    void flush();
+    bool remove(int socket);
+    void appendPollFds(std::vector<pollfd>& fds);
+    void dropClosed();
+    void closeRetired();
+    void closeAll();
+    size_t size();
+
+private:
+    size_t maxSpectators;
+    size_t maxBacklog;
+    SpectatorStats& stats;
+    // Never resized, so a flush can send from a slot without the lock:
+    // while one is sending, no slot in use is freed, only marked closing.
+    std::vector<Spectator> slots;
+    std::vector<size_t> active;
+    std::vector<size_t> freeSlots;
+    std::vector<Spectator*> sending;
+    bool flushing = false;
+    std::vector<int> retired;
+    std::vector<pollfd> pollFds;
+    // Keeps publishers one at a time, so only one touches the backlogs.
+    // Taken before mutex.
+    std::mutex publishMutex;
+    std::mutex mutex;
+
+    void vacate(size_t slot);
+    void retireMarked();
+};
+
+// The stream spectators are watching. Keeps the latest packet of each kind
+// a late joiner needs to catch up, and replays them in front of the live
+// stream. Used by the server's featured room and by the relay.
+class SpectatorFeed {
+public:
+    explicit SpectatorFeed(FanOut& fanOut) : fanOut(fanOut) {}
+
+    void publish(int packetType, const SharedPacket& packet);
+    bool join(int socket);
+
+private:
+    FanOut& fanOut;
+    // Updating the catch-up state and queuing under one lock means a
+    // spectator joining in between gets each packet exactly once. The
+    // sends happen after it is released.
+    std::mutex mutex;
+    SharedPacket waitingPacket;
+    SharedPacket mapPacket;
+    SharedPacket lastSnapshot;
+    SharedPacket gameOverPacket;
+};
+
+#endif /* FANOUT_HPP */
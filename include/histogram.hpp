@@ -0,0 +1,93 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** histogram.hpp
+*/
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+
+// Log-linear histogram: values below 16 are exact, above that every power of
+// two is split into 16 sub-buckets, so any recorded value is within ~6%.
+class Histogram {
+public:
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKET_COUNT = (64 - 3) * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        counts[bucketIndex(value)]++;
+        total++;
+        sum += value;
+        if (value > maxValue) {
+            maxValue = value;
+        }
+    }
+
+    void merge(const Histogram& other) {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        if (other.maxValue > maxValue) {
+            maxValue = other.maxValue;
+        }
+    }
+
+    void reset() { *this = Histogram(); }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    uint64_t getSum() const { return sum; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total);
+        if (rank >= total) {
+            rank = total - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen > rank) {
+                uint64_t upper = bucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    static int bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - 4;
+        return (msb - 3) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int msb = index / SUB_BUCKETS + 3;
+        int shift = msb - 4;
+        uint64_t sub = index % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+};
+
+#endif /* HISTOGRAM_HPP */
@@ -0,0 +1,39 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** interest.hpp
+*/
+
+#ifndef INTEREST_HPP
+#define INTEREST_HPP
+
+#include "common.hpp"
+
+// One grid column is as wide as a client viewport, in pixels.
+#define INTEREST_COLUMN_WIDTH 800.0f
+// Columns on each side of a viewer whose players are sent every tick.
+#define INTEREST_NEAR_COLUMNS 1
+// Players further away are in one of every this many snapshots a viewer
+// gets. Counting the viewer's snapshots rather than ticks keeps that true
+// whatever its snapshot interval, which a tick cadence sharing a factor
+// with it would not.
+#define INTEREST_DISTANT_TICKS 15
+
+// Buckets players by x-position into viewport-wide columns, so each viewer's
+// snapshot holds only the players it can see at full rate, and everyone else
+// decimated. Viewers in the same column get the same selection, so the
+// server encodes one packet per occupied column rather than per client.
+class InterestGrid {
+public:
+    void build(const std::array<Player, MAX_PLAYERS>& players);
+    void select(int column, uint32_t snapshot, std::vector<int>& visible) const;
+
+    static int columnOf(float x) { return static_cast<int>(x / INTEREST_COLUMN_WIDTH); }
+
+private:
+    // (column, player index), sorted by column.
+    std::vector<std::pair<int, int>> cells;
+};
+
+#endif /* INTEREST_HPP */
@@ -0,0 +1,52 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** link_quality.hpp
+*/
+
+#ifndef LINK_QUALITY_HPP
+#define LINK_QUALITY_HPP
+
+#include "common.hpp"
+
+// Players in a match are pinged twice a second.
+#define PING_INTERVAL_TICKS 30
+// Snapshots go out at least every this many ticks (15 Hz).
+#define MAX_SNAPSHOT_INTERVAL 4
+// Above either of these a player gets fewer snapshots, below both of the
+// recover ones it gets them back, one step per ping.
+#define RTT_DEGRADE_US 150000
+#define RTT_RECOVER_US 80000
+#define SEND_QUEUE_DEGRADE_BYTES 4096
+#define SEND_QUEUE_RECOVER_BYTES 512
+
+// What the server knows about one player's connection. The round-trip time
+// is smoothed as TCP does (RFC 6298, gain 1/8) and the jitter is the mean
+// deviation between consecutive samples, as RTP computes it (RFC 3550, gain
+// 1/16). From those and the bytes its socket has yet to send, adapt() picks
+// how many ticks apart the player's snapshots go out: a client that cannot
+// keep up gets fewer of them instead of an ever longer queue.
+class LinkQuality {
+public:
+    void addSample(int64_t rttUs);
+    void adapt(int64_t queuedBytes);
+
+    // Players on the same interval are spread over different ticks.
+    bool sendsSnapshotOn(uint32_t tick, int slot) const { return (tick + slot) % snapshotInterval == 0; }
+    // Numbers the snapshots the player gets: one more on each tick it is
+    // sent one, whatever its slot and interval.
+    uint32_t snapshotCount(uint32_t tick) const { return tick / snapshotInterval; }
+    bool isMeasured() const { return lastSampleUs >= 0; }
+    int64_t getRttUs() const { return srttUs; }
+    int64_t getJitterUs() const { return jitterUs; }
+    int getSnapshotInterval() const { return snapshotInterval; }
+
+private:
+    int64_t srttUs = 0;
+    int64_t jitterUs = 0;
+    int64_t lastSampleUs = -1;
+    int snapshotInterval = 1;
+};
+
+#endif /* LINK_QUALITY_HPP */
@@ -0,0 +1,89 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** load.hpp
+*/
+
+#ifndef LOAD_HPP
+#define LOAD_HPP
+
+#include "async.hpp"
+#include "common.hpp"
+#include "histogram.hpp"
+#include "protocol.hpp"
+#include <chrono>
+
+struct LoadConfig {
+    std::string serverIP = "127.0.0.1";
+    int port = 0;
+    std::string unixSocketPath;
+    int connections = 100;
+    int durationSeconds = 30;
+    int reportSeconds = 5;
+    int serverPid = -1;
+};
+
+struct LoadConnection {
+    std::unique_ptr<AsyncSession> session;
+    bool connected = false;
+    bool gotMap = false;
+    int playerId = -1;
+    bool jetpackOn = false;
+    unsigned int rngState = 1;
+    bool hasSnapshot = false;
+    std::chrono::steady_clock::time_point lastSnapshot;
+};
+
+struct LoadCounters {
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint64_t packetsIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t snapshots = 0;
+};
+
+// Each simulated player is one coroutine on a shared EventLoop: connect,
+// send READY, then read frames until the server hangs up, while a second
+// coroutine sends its inputs at 60 Hz.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadConfig& config);
+
+    bool run();
+
+private:
+    LoadConfig config;
+    // Before the connections, so it outlives the sessions registered with it.
+    EventLoop loop;
+    std::vector<LoadConnection> connections;
+    struct sockaddr_storage address;
+    socklen_t addressLength = 0;
+    Histogram interArrival;
+    Histogram intervalInterArrival;
+    LoadCounters total;
+    LoadCounters interval;
+    int connectFailures = 0;
+    int readyFailures = 0;
+    int closedByServer = 0;
+    long startServerCpuTicks = -1;
+    long lastServerCpuTicks = -1;
+    double startOwnCpuSeconds = 0;
+    double lastOwnCpuSeconds = 0;
+    std::chrono::steady_clock::time_point intervalStart;
+
+    void resolveAddress();
+    Task<> play(int index);
+    Task<> sendInputs(int index);
+    Task<> reportIntervals();
+    void handlePacket(LoadConnection& conn, int packetType, const char* data, int length);
+    Task<bool> sendPacket(LoadConnection& conn, int packetType, const void* data, int length);
+    int countConnected() const;
+    int countPlaying() const;
+    long readServerCpuTicks() const;
+    static double readOwnCpuSeconds();
+    void report(const char* label, const Histogram& histogram, const LoadCounters& counters,
+        double seconds, long cpuTicks, double ownCpuSeconds);
+};
+
+#endif /* LOAD_HPP */
@@ -0,0 +1,108 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** log.hpp
+*/
+
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_OFF 4
+
+#ifndef JETPACK_LOG_LEVEL
+#define JETPACK_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+extern bool debug_mode;
+
+// Levels below JETPACK_LOG_LEVEL are removed at compile time, the others are
+// only formatted when debug_mode is set, so arguments cost nothing otherwise.
+// Usage: LOG_DEBUG("Carte chargée: " << width << "x" << height);
+#define JETPACK_LOG(level, expr)                                        \
+    do {                                                                \
+        if ((level) >= JETPACK_LOG_LEVEL && debug_mode) {               \
+            LogLine jetpackLogLine(level);                              \
+            jetpackLogLine << expr;                                     \
+        }                                                               \
+    } while (0)
+
+#define LOG_TRACE(expr) JETPACK_LOG(LOG_LEVEL_TRACE, expr)
+#define LOG_DEBUG(expr) JETPACK_LOG(LOG_LEVEL_DEBUG, expr)
+#define LOG_INFO(expr) JETPACK_LOG(LOG_LEVEL_INFO, expr)
+#define LOG_WARN(expr) JETPACK_LOG(LOG_LEVEL_WARN, expr)
+
+// Formats one line into a fixed buffer and hands it to the log ring on
+// destruction; nothing here allocates.
+class LogLine {
+public:
+    static constexpr size_t MAX_LENGTH = 240;
+
+    explicit LogLine(int level) : level(level) {}
+    ~LogLine();
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text) { return append(text.data(), text.size()); }
+    LogLine& operator<<(char value) { return append(&value, 1); }
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    LogLine& operator<<(int value) { return *this << static_cast<long long>(value); }
+    LogLine& operator<<(unsigned int value) { return *this << static_cast<unsigned long long>(value); }
+    LogLine& operator<<(long value) { return *this << static_cast<long long>(value); }
+    LogLine& operator<<(unsigned long value) { return *this << static_cast<unsigned long long>(value); }
+    LogLine& operator<<(long long value);
+    LogLine& operator<<(unsigned long long value);
+    LogLine& operator<<(double value);
+
+private:
+    LogLine& append(const char* text, size_t size);
+
+    int level;
+    size_t length = 0;
+    char text[MAX_LENGTH];
+};
+
+// Bounded multi-producer ring (one sequence number per slot) drained by a
+// background writer thread. A full ring drops the line instead of blocking
+// the caller; the number of dropped lines is reported by the writer.
+class Logger {
+public:
+    static constexpr size_t CAPACITY = 1024;
+
+    static Logger& instance();
+    ~Logger();
+
+    void push(int level, const char* text, size_t length);
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        int level = 0;
+        size_t length = 0;
+        char text[LogLine::MAX_LENGTH];
+    };
+
+    Logger();
+    bool drain();
+    void writerLoop();
+
+    Slot slots[CAPACITY];
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) size_t dequeuePos = 0;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> running{true};
+    std::thread writer;
+};
+
+#endif /* LOG_HPP */
@@ -0,0 +1,56 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** matchmaker.hpp
+*/
+
+#ifndef MATCHMAKER_HPP
+#define MATCHMAKER_HPP
+
+#include "common.hpp"
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+#define DEFAULT_SKILL_RATING 1000
+#define SKILL_BUCKET_WIDTH 200
+#define LATENCY_BUCKET_MS 50
+#define LATENCY_BUCKET_COUNT 5
+// Every this many seconds in the queue, a player accepts opponents one more
+// skill and latency bucket away.
+#define MATCH_WIDEN_SECONDS 5
+
+struct QueueEntry {
+    int socket = -1;
+    int64_t enqueuedNs = 0;
+    int skillRating = DEFAULT_SKILL_RATING;
+    int latencyMs = 0;
+};
+
+using MatchGroup = std::array<QueueEntry, MAX_PLAYERS>;
+
+// Players waiting for a match, bucketed by skill rating and latency. Each
+// bucket is a FIFO, so a full group of alike players is formed in constant
+// time; players who waited long enough also reach into neighbouring buckets.
+class Matchmaker {
+public:
+    void enqueue(const QueueEntry& entry);
+    bool remove(int socket);
+    bool contains(int socket) const { return index.count(socket) != 0; }
+    size_t depth() const { return index.size(); }
+    void closeAll();
+
+    void formMatches(int64_t nowNs, std::vector<MatchGroup>& matches);
+
+private:
+    using BucketKey = std::pair<int, int>;
+
+    std::map<BucketKey, std::deque<QueueEntry>> buckets;
+    std::unordered_map<int, BucketKey> index;
+
+    static BucketKey bucketOf(const QueueEntry& entry);
+    bool formWidened(const QueueEntry& oldest, int64_t nowNs, MatchGroup& match);
+};
+
+#endif /* MATCHMAKER_HPP */
@@ -0,0 +1,113 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** metrics.hpp
+*/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "common.hpp"
+#include "fanout.hpp"
+#include "protocol.hpp"
+#include <chrono>
+
+// Prometheus-style duration histogram. Every room worker observes into the
+// same histograms, so updates are relaxed atomic adds; the scrape thread may
+// read concurrently and at worst sees an observation half accounted for.
+class DurationHistogram {
+public:
+    static constexpr int BOUND_COUNT = 12;
+    using Bounds = std::array<int64_t, BOUND_COUNT>;
+    static constexpr Bounds TICK_BOUNDS_NS = {
+        5000, 10000, 25000, 50000, 100000, 250000, 500000,
+        1000000, 2500000, 5000000, 10000000, 25000000
+    };
+    static constexpr Bounds RTT_BOUNDS_NS = {
+        500000, 1000000, 2500000, 5000000, 10000000, 25000000, 50000000,
+        100000000, 150000000, 250000000, 500000000, 1000000000
+    };
+    static constexpr Bounds WAIT_BOUNDS_NS = {
+        10000000, 50000000, 100000000, 250000000, 500000000, 1000000000,
+        2000000000, 5000000000, 10000000000, 20000000000, 30000000000, 60000000000
+    };
+
+    explicit DurationHistogram(const Bounds& bounds = TICK_BOUNDS_NS) : bounds(bounds) {}
+
+    void observe(int64_t durationNs) {
+        int bucket = 0;
+        while (bucket < BOUND_COUNT && durationNs > bounds[bucket]) {
+            bucket++;
+        }
+        bump(buckets[bucket], 1);
+        bump(count, 1);
+        bump(sumNs, durationNs);
+    }
+
+    void write(std::ostream& out, const std::string& name, const std::string& labels) const;
+
+private:
+    static void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    Bounds bounds;
+    std::array<std::atomic<uint64_t>, BOUND_COUNT + 1> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNs{0};
+};
+
+struct ServerMetrics {
+    DurationHistogram tickUpdate;
+    DurationHistogram tickCollisions;
+    DurationHistogram tickBroadcast;
+    DurationHistogram tickTotal;
+    DurationHistogram timeToMatch{DurationHistogram::WAIT_BOUNDS_NS};
+    DurationHistogram clientRtt{DurationHistogram::RTT_BOUNDS_NS};
+    // Traffic per player slot, summed over every room: slot 0 is the first
+    // player of whichever matches are or were running.
+    std::array<TrafficCounters, MAX_PLAYERS> slotTraffic;
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<uint64_t> ticksStolen{0};
+    std::atomic<uint64_t> ticksSkipped{0};
+    std::atomic<uint64_t> commandsDropped{0};
+    std::atomic<uint64_t> snapshotsSkipped{0};
+    std::atomic<uint64_t> matchesStarted{0};
+    std::atomic<uint64_t> matchesFinished{0};
+    std::atomic<uint64_t> connectionsAccepted{0};
+    std::atomic<uint64_t> connectionsRejected{0};
+    std::atomic<int> connectedClients{0};
+    std::atomic<int> queueDepth{0};
+    std::atomic<int> roomsActive{0};
+    SpectatorStats spectators;
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string render() const;
+};
+
+// Serves ServerMetrics in the Prometheus text format on 127.0.0.1:<port>
+// from its own thread, so scrapes never run on the game or I/O threads.
+class MetricsEndpoint {
+public:
+    explicit MetricsEndpoint(const ServerMetrics& metrics) : metrics(metrics) {}
+    ~MetricsEndpoint();
+
+    bool start(int port);
+    void stop();
+
+private:
+    const ServerMetrics& metrics;
+    int listenSocket = -1;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    void serve();
+    void handleRequest(int clientSocket);
+};
+
+#endif /* METRICS_HPP */
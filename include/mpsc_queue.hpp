@@ -0,0 +1,82 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** mpsc_queue.hpp
+*/
+
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded multi-producer / single-consumer queue over a fixed ring. Each
+// cell carries a sequence number saying whose turn it is: producers claim
+// a position with one compare-and-swap on the tail and publish the cell
+// through its sequence, the consumer takes cells in order without any
+// read-modify-write. Nothing blocks and nothing allocates; push() fails
+// when the ring is full. Values must be cheap to copy.
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread. False if the consumer is a whole ring behind.
+    bool push(const T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & MASK];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only. A producer still filling the next cell makes
+    // the queue look empty until it is done; nothing behind it is lost.
+    bool pop(T& value) {
+        Cell& cell = cells[head & MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(head + Capacity, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) size_t head = 0;
+    alignas(64) std::array<Cell, Capacity> cells;
+};
+
+#endif /* MPSC_QUEUE_HPP */
@@ -0,0 +1,167 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** net_backend.hpp
+*/
+
+#ifndef NET_BACKEND_HPP
+#define NET_BACKEND_HPP
+
+#include "common.hpp"
+#include "protocol.hpp"
+#include <unordered_map>
+
+// Packets a player may have waiting for its socket: two seconds of snapshots.
+#define MAX_PLAYER_BACKLOG 120
+
+// Something the lobby has to react to. A PACKET's payload stays readable
+// through NetBackend::payload() until the next call to wait().
+struct NetEvent {
+    enum Kind {
+        ACCEPTED,   // socket is a new connection on the listening socket
+        WAKE,       // socket is a wakeup descriptor that became readable
+        PACKET,     // a whole packet arrived on a watched socket
+        CLOSED      // a watched socket hung up or sent garbage; no longer watched
+    };
+
+    Kind kind;
+    int socket = -1;
+    int packetType = 0;
+    size_t offset = 0;
+    int length = 0;
+};
+
+// A player's socket as its room writes to it. Sends never block: what the
+// socket did not take yet waits in the backlog for a later flush.
+struct PeerOutput {
+    int socket = -1;
+    TrafficCounters* counters = nullptr;
+    PacketBacklog backlog{MAX_PLAYER_BACKLOG};
+    // Set once the peer fell a whole backlog behind or its socket failed;
+    // nothing is queued for it any more.
+    bool dropped = false;
+    // Whether a batch already holds it for its next flush.
+    bool batched = false;
+};
+
+// Where a room worker writes its packets. queue() adds the packet to the
+// peer's backlog and flush() sends what every peer with pending packets
+// takes without waiting, so one client that stops reading only ever holds
+// up itself. A peer whose backlog overflows or whose socket fails is shut
+// down: the lobby sees it hang up and disconnects the player.
+class SendBatch {
+public:
+    virtual ~SendBatch() = default;
+
+    void queue(PeerOutput& peer, const SharedPacket& packet) {
+        if (peer.dropped) {
+            return;
+        }
+        if (!peer.backlog.push(packet)) {
+            drop(peer, "trop lent");
+            return;
+        }
+        resume(peer);
+    }
+    // Has the next flush retry what the peer still has pending.
+    void resume(PeerOutput& peer) {
+        if (!peer.dropped && !peer.batched && !peer.backlog.empty()) {
+            peer.batched = true;
+            add(peer);
+        }
+    }
+    // Clears batched on every peer it held.
+    virtual void flush() = 0;
+
+protected:
+    virtual void add(PeerOutput& peer) = 0;
+    static void drop(PeerOutput& peer, const char* reason);
+};
+
+// Writes each peer's backlog with one non-blocking sendmsg() per flush.
+class DirectSendBatch : public SendBatch {
+public:
+    void flush() override;
+
+protected:
+    void add(PeerOutput& peer) override { peers.push_back(&peer); }
+
+private:
+    std::vector<PeerOutput*> peers;
+};
+
+// The lobby's view of its sockets: accepts connections, reads whole
+// packets from the sockets it watches and reports both as events. Watched
+// sockets stay owned by the caller, who unwatches them before closing them.
+class NetBackend {
+public:
+    virtual ~NetBackend() = default;
+
+    virtual const char* name() const = 0;
+    // The listening socket may be -1 and must be non-blocking. A wakeup
+    // descriptor is only polled for readability; reading it is the caller's job.
+    virtual bool open(int listenSocket, const std::vector<int>& wakeFds) = 0;
+    virtual void watch(int socket) = 0;
+    // For a socket whose first bytes were read elsewhere: the next wait()
+    // reports the packets among them before anything it receives.
+    void watch(int socket, const std::vector<char>& unread);
+    virtual void unwatch(int socket) = 0;
+    // Waits up to timeoutMs for events and returns how many were added,
+    // or -1 on a fatal error.
+    virtual int wait(int timeoutMs, std::vector<NetEvent>& events) = 0;
+    virtual std::unique_ptr<SendBatch> createSendBatch() = 0;
+
+    const char* payload(const NetEvent& event) const { return payloads.data() + event.offset; }
+
+    // Accepts every connection queued on a non-blocking listening socket.
+    static int acceptAll(int listenSocket, std::vector<int>& accepted);
+
+    static std::unique_ptr<NetBackend> create(const std::string& name);
+
+protected:
+    std::vector<char> payloads;
+
+    // Turns the whole packets at the front of a connection's input into
+    // PACKET events and keeps the unfinished rest. False on a header no
+    // packet of ours could have.
+    bool extractPackets(int socket, std::vector<char>& input, std::vector<NetEvent>& events);
+    // Extracts the packets handed over with watch(socket, unread); a wait()
+    // that got some should not block.
+    int extractUnread(std::vector<NetEvent>& events);
+    // The reassembly buffer of a watched socket, or null.
+    virtual std::vector<char>* watchedInput(int socket) = 0;
+
+private:
+    std::vector<int> unreadSockets;
+};
+
+// poll() over every watched socket, rebuilt on each wait. A readable socket
+// gets one non-blocking recv() and its bytes are reassembled into packets
+// per connection, so a peer that sends half a packet and stops holds up
+// nobody but itself.
+class PollBackend : public NetBackend {
+public:
+    using NetBackend::watch;
+
+    const char* name() const override { return "poll"; }
+    bool open(int listenSocket, const std::vector<int>& wakeFds) override;
+    void watch(int socket) override;
+    void unwatch(int socket) override;
+    int wait(int timeoutMs, std::vector<NetEvent>& events) override;
+    std::unique_ptr<SendBatch> createSendBatch() override;
+
+protected:
+    std::vector<char>* watchedInput(int socket) override;
+
+private:
+    int listenSocket = -1;
+    std::vector<int> wakeFds;
+    std::vector<int> watched;
+    // Indexed by descriptor, like the io_uring backend's connections.
+    std::vector<std::vector<char>> inputs;
+    std::vector<pollfd> fds;
+    std::vector<int> accepted;
+};
+
+#endif /* NET_BACKEND_HPP */
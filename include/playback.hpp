@@ -0,0 +1,44 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** playback.hpp
+*/
+
+#ifndef PLAYBACK_HPP
+#define PLAYBACK_HPP
+
+#include "replay.hpp"
+
+struct PlaybackConfig {
+    std::string replayFile;
+    int seekTick = 0;
+    double speed = 0.0;
+    int printEvery = 0;
+};
+
+// Re-simulates a recorded match from its inputs and checks every keyframe
+// and the final result against what the server recorded.
+class Playback {
+public:
+    explicit Playback(const PlaybackConfig& config);
+
+    bool run();
+
+private:
+    PlaybackConfig config;
+    ReplayReader reader;
+    Simulation simulation;
+    int ticksSimulated = 0;
+    int keyframesChecked = 0;
+    int divergences = 0;
+    std::chrono::steady_clock::time_point startTime;
+
+    void advanceTo(uint32_t tick);
+    void applyInput(const ReplayRecord& record);
+    void checkKeyframe(const ReplayRecord& record);
+    void checkEnd(const ReplayRecord& record);
+    void printState() const;
+};
+
+#endif /* PLAYBACK_HPP */
@@ -0,0 +1,89 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** profiler.hpp
+*/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "common.hpp"
+#include <chrono>
+
+struct ProfileEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+struct FrameStats {
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+    int frames = 0;
+};
+
+// Each thread records into its own preallocated ring, so a marker costs two
+// clock reads and a store. Frame times are kept over a rolling window and
+// must be recorded and read from the same thread.
+class Profiler {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+    static constexpr size_t FRAME_WINDOW = 240;
+
+    static Profiler& instance();
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    void setThreadName(const std::string& name);
+    void record(const char* name, int64_t startNs, int64_t endNs);
+    void recordFrame(int64_t durationNs);
+    FrameStats frameStats() const;
+    bool writeChromeTrace(const std::string& filename) const;
+
+private:
+    struct ThreadBuffer {
+        int threadId = 0;
+        std::string name;
+        std::vector<ProfileEvent> events;
+        size_t written = 0;
+    };
+
+    Profiler() = default;
+    ThreadBuffer& localBuffer();
+
+    std::atomic<bool> enabled{false};
+    mutable std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::array<int64_t, FRAME_WINDOW> frameTimes{};
+    size_t frameCount = 0;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), startNs(Profiler::instance().isEnabled() ? Profiler::now() : 0) {}
+    ~ProfileScope() {
+        if (startNs != 0) {
+            Profiler::instance().record(name, startNs, Profiler::now());
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    int64_t startNs;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+#endif /* PROFILER_HPP */
@@ -10,24 +10,114 @@
 
 #include "common.hpp"
 #include "map.hpp"
+#include "wire.hpp"
+#include <sys/uio.h>
 #define ASSIGN_PLAYER_ID 7
+#define SPECTATE 8
+#define LEADERBOARD 9
+#define PING 10
+#define PONG 11
+// Buffers a PacketPool keeps at most; beyond that packets are plain allocations.
+#define PACKET_POOL_SIZE 256
 
+// Decoded form of Wire::HeaderLayout.
 struct PacketHeader {
     int type;
     int length;
 };
 
+struct TrafficCounters {
+    std::atomic<uint64_t> packetsSent{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<uint64_t> packetsReceived{0};
+    std::atomic<uint64_t> bytesReceived{0};
+};
+
+// A complete packet (header and payload) encoded once and shared by every
+// recipient; whoever still has it queued keeps it alive.
+using SharedPacket = std::shared_ptr<const std::vector<char>>;
+
+// Packet buffers one owner encodes into again and again, such as a room's
+// snapshots. A buffer is handed out anew once every socket and spectator
+// that queued it has let go of it, and keeps its capacity, so a match in
+// steady state encodes without touching the heap. Only the owner's thread
+// may call acquire(); the packets themselves can be released anywhere.
+class PacketPool {
+public:
+    explicit PacketPool(size_t bufferCapacity) : bufferCapacity(bufferCapacity) {}
+
+    std::shared_ptr<std::vector<char>> acquire(size_t size);
+    size_t size() const { return buffers.size(); }
+
+private:
+    size_t bufferCapacity;
+    std::vector<std::shared_ptr<std::vector<char>>> buffers;
+    size_t next = 0;
+};
+
+// Packets waiting for a non-blocking socket: shared packets oldest first,
+// with how much of the oldest already went out, in a ring sized when the
+// backlog is created so queueing never allocates. A slow reader only costs
+// its own references to the packets.
+class PacketBacklog {
+public:
+    explicit PacketBacklog(size_t capacity = 0) : ring(capacity) {}
+
+    // False when the ring is full.
+    bool push(const SharedPacket& packet);
+    void clear();
+    size_t size() const { return queued; }
+    bool empty() const { return queued == 0; }
+    size_t bytes() const { return pendingBytes; }
+
+    // Points parts at the unsent bytes of up to maxParts packets.
+    size_t gather(iovec* parts, size_t maxParts) const;
+    // Drops what a send took from the front.
+    void consume(size_t sent, TrafficCounters* counters);
+    // Sends as much as the socket takes without blocking. False once the
+    // socket failed; whatever it did not take stays queued.
+    bool flush(int socket, TrafficCounters* counters);
+
+private:
+    std::vector<SharedPacket> ring;
+    size_t head = 0;
+    size_t queued = 0;
+    size_t offset = 0;
+    size_t pendingBytes = 0;
+};
+
 class Protocol {
 public:
-    static bool sendPacket(int socket, int packetType, const void* data = nullptr, int dataLength = 0);
-    static int receivePacket(int socket, int& packetType, void* buffer, int bufferSize);
-    static bool sendMap(int socket, const Map& map);
+    static bool sendPacket(int socket, int packetType, const void* data = nullptr, int dataLength = 0,
+        TrafficCounters* counters = nullptr);
+    static int receivePacket(int socket, int& packetType, void* buffer, int bufferSize,
+        TrafficCounters* counters = nullptr);
+    static bool sendMap(int socket, const Map& map, TrafficCounters* counters = nullptr);
     static bool receiveMap(int socket, Map& map);
     static bool sendPlayerPosition(int socket, int playerId, const Vector2& position, bool jetpackOn);
-    static bool sendGameState(int socket, GameState state, const std::array<Player, MAX_PLAYERS>& players);
-    static bool sendGameOver(int socket, int winnerId, const std::array<int, MAX_PLAYERS>& scores);
-    static bool sendWaitingStatus(int socket, int connectedPlayers);
+    static bool sendGameState(int socket, GameState state, const std::array<Player, MAX_PLAYERS>& players,
+        TrafficCounters* counters = nullptr);
+    static bool sendGameOver(int socket, int winnerId, const std::array<int, MAX_PLAYERS>& scores,
+        TrafficCounters* counters = nullptr);
+    static bool sendWaitingStatus(int socket, int connectedPlayers, TrafficCounters* counters = nullptr);
+    static bool sendInt(int socket, int packetType, int value, TrafficCounters* counters = nullptr);
+
+    static void writeHeader(char* out, int packetType, int dataLength);
+    static bool readHeader(const char* in, PacketHeader& header);
 
+    static SharedPacket encodePacket(int packetType, const void* data = nullptr, int dataLength = 0);
+    // With a pool, the packet is encoded into one of its free buffers.
+    static SharedPacket encodeGameState(GameState state, const std::array<Player, MAX_PLAYERS>& players,
+        PacketPool* pool = nullptr);
+    static SharedPacket encodeGameState(GameState state, const std::array<Player, MAX_PLAYERS>& players,
+        const std::vector<int>& visible, PacketPool* pool = nullptr);
+    static SharedPacket encodeLeaderboard(const std::array<Player, MAX_PLAYERS>& players,
+        PacketPool* pool = nullptr);
+    static SharedPacket encodeGameOver(int winnerId, const std::array<int, MAX_PLAYERS>& scores,
+        PacketPool* pool = nullptr);
+    static SharedPacket encodePing(int64_t sentUs, int64_t rttUs, int64_t jitterUs, int snapshotInterval,
+        PacketPool* pool = nullptr);
+    static SharedPacket encodeInt(int packetType, int value);
 };
 
 #endif /* PROTOCOL_HPP */
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** relay.hpp
+*/
+
+#ifndef RELAY_HPP
+#define RELAY_HPP
+
+#include "common.hpp"
+#include "fanout.hpp"
+#include "protocol.hpp"
+#include <chrono>
+
+#define RELAY_MAX_SPECTATORS 4096
+// A connection must say READY or SPECTATE within this delay.
+#define RELAY_HANDSHAKE_TIMEOUT_MS 5000
+
+struct RelayConfig {
+    std::string upstreamIP = "127.0.0.1";
+    int upstreamPort = 0;
+    std::string upstreamUnixPath;
+    int listenPort = 0;
+    int maxSpectators = RELAY_MAX_SPECTATORS;
+    int reportSeconds = 0;
+};
+
+// A connection whose first packet header has not fully arrived yet.
+struct PendingClient {
+    int socket = -1;
+    std::chrono::steady_clock::time_point deadline;
+    size_t received = 0;
+    char header[Wire::HeaderLayout::SIZE];
+};
+
+// Watches a match as a spectator of a server, or of another relay, and
+// repeats every packet unchanged to its own spectators. Each upstream packet
+// is copied once and shared by all of them; slow readers are absorbed here,
+// so the simulating server only ever sees the relay as one spectator.
+class Relay {
+public:
+    explicit Relay(const RelayConfig& config);
+    ~Relay();
+
+    bool start();
+    void stop();
+
+private:
+    RelayConfig config;
+    int upstreamSocket = -1;
+    int listenSocket = -1;
+    std::atomic<bool> running{false};
+    std::thread upstreamThread;
+    std::vector<PendingClient> pendingClients;
+
+    SpectatorStats stats;
+    FanOut spectators;
+    SpectatorFeed feed{spectators};
+    TrafficCounters upstreamTraffic;
+
+    bool connectUpstream();
+    bool openListenSocket();
+    void upstreamLoop();
+    void forward(int packetType, const char* data, int dataLength);
+    void handleConnections();
+    void acceptClients();
+    bool handlePendingMessage(PendingClient& client);
+    void expirePendingClients();
+    void handleSpectatorMessage(int clientSocket);
+    void report();
+};
+
+#endif /* RELAY_HPP */
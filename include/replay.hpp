@@ -0,0 +1,95 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** replay.hpp
+*/
+
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include "simulation.hpp"
+#include <fstream>
+
+// Replay file layout (all integers little-endian):
+//   header   "JPRP" u32 version, u64 seed, u64 map hash, u32 player count,
+//            u32 keyframe interval, u32 map length, map text
+//   records  u8 type followed by
+//            INPUT     u32 tick, u32 jetpack mask, u32 connected mask
+//            KEYFRAME  u32 tick, u32 size, Simulation::serialize() bytes
+//            END       u32 tick, i32 winner
+//   index    u32 count, then (u32 tick, u64 offset) per keyframe
+//   footer   u64 index offset, "JPIX"
+// Inputs are only written when they change and apply from their tick on.
+namespace Replay {
+    constexpr uint32_t VERSION = 1;
+    constexpr uint8_t RECORD_INPUT = 1;
+    constexpr uint8_t RECORD_KEYFRAME = 2;
+    constexpr uint8_t RECORD_END = 3;
+    constexpr size_t FOOTER_SIZE = 12;
+}
+
+struct ReplayRecord {
+    uint8_t type = 0;
+    uint32_t tick = 0;
+    uint32_t jetpackMask = 0;
+    uint32_t connectedMask = 0;
+    int32_t winnerId = -1;
+    const uint8_t* state = nullptr;
+    uint32_t stateSize = 0;
+};
+
+class ReplayWriter {
+public:
+    ~ReplayWriter();
+
+    bool open(const std::string& filename, const Simulation& simulation, int keyframeInterval = Simulation::TICKS_PER_SECOND);
+    bool isOpen() const { return file.is_open(); }
+    void recordTick(const Simulation& simulation);
+    void finish(const Simulation& simulation);
+
+private:
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> state;
+    std::vector<std::pair<uint32_t, uint64_t>> index;
+    uint64_t offset = 0;
+    uint32_t keyframeInterval = Simulation::TICKS_PER_SECOND;
+    uint32_t lastJetpackMask = 0;
+    uint32_t lastConnectedMask = 0;
+
+    void flush();
+};
+
+class ReplayReader {
+public:
+    bool open(const std::string& filename);
+
+    uint64_t getSeed() const { return seed; }
+    const Map& getMap() const { return map; }
+    int getKeyframeInterval() const { return keyframeInterval; }
+    bool hasIndex() const { return indexed; }
+    const std::vector<std::pair<uint32_t, uint64_t>>& getIndex() const { return index; }
+
+    // Reads the record at cursor and advances it; false at the end of the records.
+    bool next(size_t& cursor, ReplayRecord& record) const;
+    // Restores the last keyframe at or before tick into simulation and returns
+    // the cursor of the record that follows it.
+    bool seek(Simulation& simulation, uint32_t tick, size_t& cursor) const;
+    size_t firstRecord() const { return recordsBegin; }
+
+private:
+    std::vector<uint8_t> data;
+    uint64_t seed = 0;
+    Map map;
+    int keyframeInterval = 0;
+    size_t recordsBegin = 0;
+    size_t recordsEnd = 0;
+    bool indexed = false;
+    std::vector<std::pair<uint32_t, uint64_t>> index;
+
+    bool readIndex();
+    void scanIndex();
+};
+
+#endif /* REPLAY_HPP */
@@ -0,0 +1,178 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** room.hpp
+*/
+
+#ifndef ROOM_HPP
+#define ROOM_HPP
+
+#include "common.hpp"
+#include "fanout.hpp"
+#include "interest.hpp"
+#include "link_quality.hpp"
+#include "map.hpp"
+#include "metrics.hpp"
+#include "mpsc_queue.hpp"
+#include "net_backend.hpp"
+#include "protocol.hpp"
+#include "replay.hpp"
+#include "simulation.hpp"
+#include <chrono>
+#include <condition_variable>
+
+// Scores and status of every player go out twice a second.
+#define LEADERBOARD_TICKS 30
+// Commands a room can have waiting between two ticks: seconds of input.
+#define ROOM_COMMAND_QUEUE_SIZE 256
+// Ticks a finished room waits for its last packets to reach slow players.
+#define ROOM_DRAIN_TICKS 60
+
+// Something a player did, posted by the lobby and applied by the room at
+// the start of its next tick, in the order it happened.
+struct RoomCommand {
+    enum Kind : uint8_t {
+        INPUT,
+        DISCONNECT,
+        RTT_SAMPLE  // rttUs: a PONG came back after that long
+    };
+
+    Kind kind = INPUT;
+    uint8_t slot = 0;
+    bool jetpackOn = false;
+    uint32_t rttUs = 0;
+};
+
+// One match between the players the matchmaker grouped together. The lobby
+// thread starts it and posts it commands; afterwards only the RoomScheduler
+// ticks it, on one worker at a time, and that worker is the only one to
+// touch the simulation or write to its sockets. Once the match is over the
+// room keeps being ticked until its last packets went out, or for at most
+// ROOM_DRAIN_TICKS; the lobby closes the sockets once isFinished() is set,
+// which the worker does after that.
+class Room {
+public:
+    Room(int id, const Map& map, const std::array<int, MAX_PLAYERS>& sockets, ServerMetrics& metrics);
+
+    int getId() const { return id; }
+    int getSocket(int slot) const { return sockets[slot]; }
+    void feature(SpectatorFeed* spectatorFeed);
+    void setReplayFile(const std::string& path) { replayFile = path; }
+
+    void start();
+    bool tick(SendBatch& out);
+    void handlePacket(int slot, int packetType, const char* data, int dataSize);
+    void disconnect(int slot);
+    void markFinished() { finished.store(true, std::memory_order_release); }
+    bool isFinished() const { return finished.load(std::memory_order_acquire); }
+    void closeSockets();
+
+private:
+    int id;
+    Map map;
+    Simulation simulation;
+    std::array<int, MAX_PLAYERS> sockets;
+    std::array<PeerOutput, MAX_PLAYERS> outputs;
+    int drainTicks = 0;
+    MpscQueue<RoomCommand, ROOM_COMMAND_QUEUE_SIZE> commands;
+    // Slots whose disconnect found the queue full: a flood of input must
+    // not make the room miss a player leaving.
+    std::atomic<uint32_t> lostDisconnects{0};
+    // Slots whose press was released before the tick it arrived in: they
+    // get that one tick of thrust and are released before the next one.
+    uint32_t releaseAfterStep = 0;
+    ServerMetrics& metrics;
+    std::atomic<SpectatorFeed*> feed{nullptr};
+    SharedPacket mapPacket;
+    std::string replayFile;
+    ReplayWriter replay;
+    GameState gameState = WAITING;
+    InterestGrid interest;
+    // Everything a tick encodes comes from here and the scratch below is
+    // sized for a full room up front, so once the match has warmed up a
+    // tick makes no heap allocation. Lives and dies with the match.
+    PacketPool packets{Wire::HeaderLayout::SIZE + Wire::GameStateLayout::SIZE};
+    std::vector<int> visiblePlayers;
+    // Viewers in the same column and at the same point of the distant
+    // cadence see the same players, so they share one encoded snapshot.
+    struct ColumnPacket {
+        int column;
+        uint32_t distantPhase;
+        SharedPacket packet;
+    };
+    std::vector<ColumnPacket> columnPackets;
+    std::array<LinkQuality, MAX_PLAYERS> links;
+    std::atomic<bool> finished{false};
+
+    void applyCommands();
+    bool drainOutput(SendBatch& out);
+    void broadcastGameState(SendBatch& out);
+    void sendPings(SendBatch& out);
+    void broadcast(SendBatch& out, int packetType, const SharedPacket& packet);
+    void publish(int packetType, const SharedPacket& packet);
+    void endGame(SendBatch& out);
+};
+
+// Ticks every running room once per game tick on a fixed pool of worker
+// threads, one per core unless told otherwise. Each room keeps its own
+// deadline and has a home worker, the least loaded one when it starts,
+// which keeps it in a heap ordered by deadline. A worker ticks whichever of
+// its rooms are due, then steals due rooms from the others and adopts
+// them, flushes what it queued without waiting on any socket, and only
+// then puts the rooms back with their next deadline: a room is in one
+// worker's hands at a time, and so are its sockets' backlogs. Rooms are
+// not isolated from each other: a slow room holds up the due rooms behind
+// it on its worker until another worker is free to steal them, but never
+// the rooms of the others. A room a whole tick late skips the ticks it
+// missed rather than running them back to back. Workers with no room due
+// sleep; with no match running at all, until one starts.
+class RoomScheduler {
+public:
+    explicit RoomScheduler(ServerMetrics& metrics) : metrics(metrics) {}
+    ~RoomScheduler();
+
+    // 0 workers means one per core. With pinning, worker i stays on core i.
+    bool start(int workerCount, bool pinToCores, NetBackend& backend);
+    void stop();
+    void dispatch(const std::shared_ptr<Room>& room);
+    int workerCount() const { return workers.size(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Scheduled {
+        std::shared_ptr<Room> room;
+        Clock::time_point deadline;
+    };
+
+    struct Worker {
+        int id = 0;
+        std::unique_ptr<SendBatch> sendBatch;
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        // Min-heap on the deadline, under mutex.
+        std::vector<std::unique_ptr<Scheduled>> rooms;
+        std::atomic<int> homeRooms{0};
+        // Only touched by the worker itself: the rooms it ticked since its
+        // last flush, kept out of every heap until that flush is done.
+        std::vector<std::unique_ptr<Scheduled>> ticked;
+        std::vector<std::unique_ptr<Scheduled>> ended;
+    };
+
+    ServerMetrics& metrics;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running{false};
+    std::atomic<int> roomCount{0};
+    Clock::time_point epoch;
+
+    void run(Worker& self);
+    std::unique_ptr<Scheduled> take(Worker& self, Clock::time_point now);
+    void reschedule(Worker& self, Clock::time_point now);
+    void sleep(Worker& self);
+    static void push(Worker& worker, std::unique_ptr<Scheduled> entry);
+    void pin(Worker& worker, int core);
+};
+
+#endif /* ROOM_HPP */
@@ -8,41 +8,137 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include "async.hpp"
 #include "common.hpp"
+#include "fanout.hpp"
 #include "map.hpp"
+#include "matchmaker.hpp"
+#include "metrics.hpp"
+#include "net_backend.hpp"
 #include "protocol.hpp"
+#include "room.hpp"
+#include "timer_wheel.hpp"
+#include <unordered_map>
 
+#define MAX_SPECTATORS 512
+#define DEFAULT_ROOM_WORKERS 0
+#define DEFAULT_LISTEN_BACKLOG SOMAXCONN
+#define DEFAULT_NET_BACKEND "poll"
+// A connection must say READY or SPECTATE within this delay.
+#define HANDSHAKE_TIMEOUT_MS 5000
+// Queued players get the queue depth this often, so dead peers show up.
+#define QUEUE_KEEPALIVE_MS 2000
+// A player in a match who sends nothing for this long is dropped from it.
+#define PLAYER_IDLE_TIMEOUT_MS 10000
+
+// A connection whose role is not known yet: the session reading its first
+// packet, and the timer that closes it if none comes.
+struct PendingHandshake {
+    AsyncSession* session = nullptr;
+    TimerWheel::Id timer = 0;
+};
+
+// Where the lobby thread routes input from a player who is in a match.
+struct PlayerLink {
+    std::shared_ptr<Room> room;
+    int slot = -1;
+    int64_t lastPacketMs = 0;
+    TimerWheel::Id idleTimer = 0;
+};
+
+// The lobby: accepts connections, queues players for matchmaking, starts
+// rooms and hands them to the room scheduler, and routes each player's
+// input to its room. Spectators watch the featured room, the oldest one running.
+// Connections are accepted by the lobby itself or, with listener threads,
+// by one SO_REUSEPORT socket per thread that hands them over to the lobby.
+// The lobby's sockets are read through a NetBackend, poll or io_uring,
+// chosen at startup; room workers write through its SendBatch. A new
+// connection is first greeted by a coroutine on the lobby's own EventLoop,
+// whose epoll descriptor the backend watches, and only handed to the
+// backend once it said READY. Handshake, keepalive and idle timeouts all
+// run on one TimerWheel on the lobby thread.
 class Server {
 public:
     Server(int port, const std::string& mapFile);
     ~Server();
 
+    // Runs the lobby on the calling thread until requestStop().
     bool start();
     void stop();
+    // Makes start() return. Only writes to an eventfd, so a signal handler
+    // or any thread may call it, even before start().
+    void requestStop();
+    void setUnixSocketPath(const std::string& path) { unixSocketPath = path; }
+    void setMetricsPort(int port) { metricsPort = port; }
+    void setReplayFile(const std::string& path) { replayFile = path; }
+    void setRoomWorkers(int count) { roomWorkerCount = count; }
+    void setPinRoomWorkers(bool enabled) { pinRoomWorkers = enabled; }
+    void setListenBacklog(int backlog) { listenBacklog = backlog; }
+    void setListenerThreads(int count) { listenerThreadCount = count; }
+    void setNetBackend(const std::string& name) { backendName = name; }
 
 private:
+    int openListenSocket(bool reusePort);
+    bool openListenerThreads();
+
     int port;
     std::string mapFile;
+    std::string unixSocketPath;
     int serverSocket = -1;
+    int listenBacklog = DEFAULT_LISTEN_BACKLOG;
+    int listenerThreadCount = 0;
+    std::vector<int> listenerSockets;
+    std::vector<std::thread> listenerThreads;
+    // Sockets accepted by listener threads, waiting for the lobby; wakeFd
+    // interrupts the lobby's poll when some arrive.
+    std::mutex acceptedMutex;
+    std::vector<int> acceptedSockets;
+    int wakeFd = -1;
+    int stopFd = -1;
+    std::string backendName = DEFAULT_NET_BACKEND;
+    std::unique_ptr<NetBackend> backend;
     Map gameMap;
-    std::array<Player, MAX_PLAYERS> players;
-    std::array<int, MAX_PLAYERS> clientSockets;
-    GameState gameState = WAITING;
+    EventLoop handshakes;
+    std::unordered_map<int, PendingHandshake> pendingSockets;
+    Matchmaker matchmaker;
+    std::unordered_map<int, TimerWheel::Id> keepaliveTimers;
+    std::vector<MatchGroup> formedMatches;
+    std::unordered_map<int, PlayerLink> players;
+    std::vector<std::shared_ptr<Room>> rooms;
+    int roomWorkerCount = DEFAULT_ROOM_WORKERS;
+    bool pinRoomWorkers = false;
+    int nextRoomId = 1;
+    int featuredRoomId = -1;
     std::atomic<bool> running{false};
-    const float GRACE_PERIOD_SECONDS = 3.0f;
-    std::chrono::steady_clock::time_point gameStartTime;
+    int metricsPort = 0;
+    ServerMetrics metrics;
+    RoomScheduler scheduler{metrics};
+    MetricsEndpoint metricsEndpoint{metrics};
+    FanOut spectators{MAX_SPECTATORS, MAX_SPECTATOR_BACKLOG, metrics.spectators};
+    SpectatorFeed spectatorFeed{spectators};
+    std::string replayFile;
+    int64_t nowMs = 0;
+    TimerWheel timers{ServerMetrics::now() / 1000000};
 
     void handleConnections();
-    bool acceptClient();
-    void handleClientMessage(int clientIndex);
-    void gameLoop();
-    void updateGameState();
-    void checkCollisions(int playerIndex);
-    void checkCoinCollisions(int playerIndex);
-    void broadcastGameState();
-    void endGame(int winnerId);
-    int getConnectedClientCount() const;
-    void checkGameEndCondition();
+    void listenerLoop(int listenSocket);
+    void takeAcceptedSockets();
+    void adoptClient(int clientSocket);
+    Task<> greet(int clientSocket);
+    void handlePacket(int clientSocket, int packetType, const char* data, int dataSize);
+    void handleClosed(int clientSocket);
+    void enqueuePlayer(int clientSocket, const char* data, int dataSize, const std::vector<char>& unread);
+    void addSpectator(int clientSocket);
+    void runMatchmaking();
+    void startRoom(const MatchGroup& match);
+    void sweepRooms();
+    void sweepSpectators();
+    void expireHandshake(int clientSocket);
+    void sendKeepalive(int clientSocket);
+    void sendWaitingStatus(int clientSocket, int queued);
+    void cancelKeepalive(int clientSocket);
+    void checkIdle(int clientSocket);
+    int measureLatencyMs(int clientSocket) const;
 };
 
 #endif /* SERVER_HPP */
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** session.hpp
+*/
+
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include "common.hpp"
+#include "map.hpp"
+#include "protocol.hpp"
+
+struct ClientSnapshot {
+    GameState gameState = WAITING;
+    std::array<Player, MAX_PLAYERS> players;
+    int myPlayerId = -1;
+    int waitingPlayers = 1;
+    int winnerId = -1;
+    std::shared_ptr<const Map> map = std::make_shared<Map>();
+    // As the server measured them, from its latest PING; rttUs is -1 until
+    // the server has a measurement.
+    int64_t rttUs = -1;
+    int64_t jitterUs = 0;
+    int snapshotInterval = 1;
+};
+
+// Connection and protocol state of one client, without any rendering or audio.
+// Only the thread calling poll() may touch state(); sendPlayerPosition() may
+// be called from another thread with its own copy of the snapshot.
+class ClientSession {
+public:
+    ClientSession(const std::string& serverIP, int port);
+    ~ClientSession();
+
+    void setSpectator(bool enabled) { spectator = enabled; }
+    bool isSpectator() const { return spectator; }
+    void setSkillRating(int rating) { skillRating = rating; }
+    bool connect();
+    void disconnect();
+    bool isConnected() const { return clientSocket >= 0; }
+    int poll(int timeoutMs);
+    bool sendPlayerPosition(const ClientSnapshot& snapshot, bool jetpackOn) const;
+    const ClientSnapshot& state() const { return netState; }
+
+private:
+    std::string serverIP;
+    int port;
+    int clientSocket = -1;
+    bool spectator = false;
+    int skillRating = -1;
+    ClientSnapshot netState;
+
+    void handleServerMessage(int packetType, char* buffer, int dataSize);
+};
+
+#endif /* SESSION_HPP */
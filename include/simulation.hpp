@@ -0,0 +1,61 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** simulation.hpp
+*/
+
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include "common.hpp"
+#include "map.hpp"
+
+// Authoritative match simulation. It only advances through step() and only
+// changes through setJetpack()/disconnectPlayer(), so the same map, seed and
+// input sequence always produce the same match (see replay.hpp).
+class Simulation {
+public:
+    static constexpr float CELL_SIZE = 32.0f;
+    static constexpr int TICKS_PER_SECOND = 60;
+    static constexpr int GRACE_TICKS = 2 * TICKS_PER_SECOND;
+
+    void start(const Map& startMap, uint64_t matchSeed);
+    void step();
+    void updateGameState();
+    void checkCollisions(int playerIndex);
+
+    void setJetpack(int playerIndex, bool jetpackOn);
+    void disconnectPlayer(int playerIndex);
+    bool isConnected(int playerIndex) const { return connected[playerIndex]; }
+
+    GameState getState() const { return state; }
+    int getWinnerId() const { return winnerId; }
+    int getTick() const { return tick; }
+    uint64_t getSeed() const { return seed; }
+    bool inGracePeriod() const { return tick < GRACE_TICKS; }
+    const std::array<Player, MAX_PLAYERS>& getPlayers() const { return players; }
+    const Map& getMap() const { return map; }
+
+    void setCollisionTiming(bool enabled) { collisionTiming = enabled; }
+    int64_t getCollisionNs() const { return collisionNs; }
+
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size);
+
+private:
+    Map map;
+    std::array<Player, MAX_PLAYERS> players;
+    std::array<bool, MAX_PLAYERS> connected{};
+    GameState state = WAITING;
+    int winnerId = -1;
+    int tick = 0;
+    uint64_t seed = 0;
+    bool collisionTiming = false;
+    int64_t collisionNs = 0;
+
+    void endGame(int winner);
+    void checkGameEndCondition();
+};
+
+#endif /* SIMULATION_HPP */
@@ -0,0 +1,55 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** sound_pool.hpp
+*/
+
+#ifndef SOUND_POOL_HPP
+#define SOUND_POOL_HPP
+
+#include <SFML/Audio.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+enum SoundId {
+    SOUND_JETPACK_START = 0,
+    SOUND_JETPACK_LOOP,
+    SOUND_JETPACK_STOP,
+    SOUND_COIN_PICKUP,
+    SOUND_ZAPPER_HIT,
+    SOUND_COUNT
+};
+
+// Fixed set of voices for one-shot effects. Buffers are indexed by SoundId,
+// so playing never allocates or looks anything up by name. When every voice
+// is busy the oldest one of the lowest priority is stolen, unless all of
+// them outrank the new sound. Buffers may be decoded and marked ready on
+// another thread; a sound only plays once markReady() has been called.
+class SoundPool {
+public:
+    static constexpr int VOICE_COUNT = 8;
+
+    bool load(SoundId id, const std::string& filename);
+    bool loadFromMemory(SoundId id, const void* data, size_t size);
+    void markReady(SoundId id) { ready[id].store(true, std::memory_order_release); }
+    bool isReady(SoundId id) const { return ready[id].load(std::memory_order_acquire); }
+    const sf::SoundBuffer& buffer(SoundId id) const { return buffers[id]; }
+    int play(SoundId id, int priority = 0);
+    void stopAll();
+
+private:
+    std::array<sf::SoundBuffer, SOUND_COUNT> buffers;
+    std::array<std::atomic<bool>, SOUND_COUNT> ready{};
+    std::array<sf::Sound, VOICE_COUNT> voices;
+    std::array<int, VOICE_COUNT> priorities{};
+    std::array<uint64_t, VOICE_COUNT> startOrder{};
+    uint64_t playCount = 0;
+    int nextVoice = 0;
+
+    int findVoice(int priority);
+};
+
+#endif /* SOUND_POOL_HPP */
@@ -0,0 +1,69 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** timer_wheel.hpp
+*/
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include "common.hpp"
+#include <functional>
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+
+// Hierarchical timing wheel with a resolution of one millisecond: level 0
+// holds the next 64 ms one slot per millisecond, each level above covers 64
+// times the span of the one below, and a slot is spread over the level
+// below when time reaches it. Timers live in a slab with intrusive lists,
+// so schedule() and cancel() are O(1) however many are pending; delays
+// beyond the top level (about 4.6 hours) are clamped to it. Not
+// thread-safe: it belongs to the thread that calls advance().
+class TimerWheel {
+public:
+    // 0 is never a valid id. Ids are not reused, so cancelling a timer that
+    // already fired is harmless.
+    using Id = uint64_t;
+
+    explicit TimerWheel(int64_t nowMs = 0);
+
+    Id schedule(int64_t delayMs, std::function<void()> callback);
+    bool cancel(Id id);
+    // Runs every timer due by nowMs, in order. Callbacks may schedule and
+    // cancel timers, including ones due in the same call.
+    size_t advance(int64_t nowMs);
+    // How long a poll may sleep without making a timer late, capped at maxMs.
+    int timeoutMs(int64_t nowMs, int maxMs) const;
+    size_t size() const { return count; }
+
+private:
+    static constexpr int SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        int64_t expiresMs = 0;
+        uint32_t generation = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+        std::function<void()> callback;
+    };
+
+    std::vector<Node> nodes;
+    uint32_t freeList = NONE;
+    uint32_t heads[TIMER_WHEEL_LEVELS][SLOTS];
+    uint64_t occupied[TIMER_WHEEL_LEVELS] = {};
+    int64_t currentMs;
+    size_t count = 0;
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int level);
+};
+
+#endif /* TIMER_WHEEL_HPP */
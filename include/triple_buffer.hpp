@@ -0,0 +1,54 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** triple_buffer.hpp
+*/
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Single producer / single consumer handoff: the producer fills writeBuffer()
+// and publishes it, the consumer always gets the latest complete value.
+// Neither side ever blocks or waits on the other.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& writeBuffer() { return buffers[back]; }
+
+    void publish() {
+        uint8_t previous = middle.exchange(back | DIRTY, std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+    }
+
+    bool hasNewData() const {
+        return (middle.load(std::memory_order_relaxed) & DIRTY) != 0;
+    }
+
+    const T& read() {
+        if (hasNewData()) {
+            uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+            front = previous & INDEX_MASK;
+        }
+        return buffers[front];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    std::array<T, 3> buffers;
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t back = 0;
+    alignas(64) uint8_t front = 2;
+};
+
+#endif /* TRIPLE_BUFFER_HPP */
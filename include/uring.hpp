@@ -0,0 +1,161 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** uring.hpp
+*/
+
+#ifndef URING_HPP
+#define URING_HPP
+
+#include "net_backend.hpp"
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+#define URING_ENTRIES 1024
+#define URING_SEND_ENTRIES 256
+#define URING_BUFFER_COUNT 512
+#define URING_BUFFER_SIZE 4096
+#define URING_MAX_IOV 64
+
+// A submission and completion queue pair set up with the raw io_uring
+// system calls. Not thread-safe: each thread that needs one owns its own.
+class UringRing {
+public:
+    UringRing() = default;
+    UringRing(const UringRing&) = delete;
+    UringRing& operator=(const UringRing&) = delete;
+    ~UringRing();
+
+    bool setup(unsigned entries, unsigned flags = 0);
+    int descriptor() const { return ringFd; }
+
+    // A zeroed entry to fill, or nullptr once the queue is full.
+    io_uring_sqe* nextSqe();
+    // Submits everything queued so far and waits for at least waitFor
+    // completions, or timeoutMs when it is not negative. Returns -errno.
+    int submit(unsigned waitFor, int timeoutMs = -1);
+    // Drops entries queued since the last successful submit.
+    void discardUnsubmitted();
+
+    template <typename Handler>
+    unsigned forEachCompletion(Handler handler) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        unsigned count = tail - head;
+        for (; head != tail; head++) {
+            handler(cqes[head & cqMask]);
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    int ringFd = -1;
+    unsigned features = 0;
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned* sqArray = nullptr;
+    unsigned sqeTail = 0;
+    unsigned submittedTail = 0;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+// The lobby on io_uring: one multishot accept on the listening socket and
+// one multishot recv per watched socket, all filling buffers the kernel
+// picks from a shared provided-buffer ring (or, where the ring does not
+// work, from buffers provided with IORING_OP_PROVIDE_BUFFERS). Bytes are reassembled into
+// packets per connection, so a wait costs one io_uring_enter however many
+// packets arrived. Needs Linux 6.0 or later; from 6.1 on, completions are
+// also deferred until the lobby waits for them.
+class UringBackend : public NetBackend {
+public:
+    ~UringBackend() override;
+
+    using NetBackend::watch;
+
+    const char* name() const override { return "uring"; }
+    bool open(int listenSocket, const std::vector<int>& wakeFds) override;
+    void watch(int socket) override;
+    void unwatch(int socket) override;
+    int wait(int timeoutMs, std::vector<NetEvent>& events) override;
+    std::unique_ptr<SendBatch> createSendBatch() override;
+
+protected:
+    std::vector<char>* watchedInput(int socket) override;
+
+private:
+    // Indexed by descriptor, and kept when the socket goes away, so the
+    // next connection on the same descriptor reuses its input buffer.
+    struct Connection {
+        uint32_t generation = 0;
+        std::vector<char> input;
+    };
+
+    int listenSocket = -1;
+    io_uring_buf_ring* bufferRing = nullptr;
+    size_t bufferRingSize = 0;
+    std::vector<char> buffers;
+    // Bumped on every watch, and carried by the socket's requests, so a
+    // completion for a descriptor that has since been closed and reused
+    // is recognised and ignored.
+    uint32_t nextGeneration = 1;
+    // generation is 0 for a descriptor that is not watched.
+    std::vector<Connection> connections;
+    // Last, so the ring is closed before the buffers it writes to go away.
+    UringRing ring;
+
+    Connection* findConnection(int socket);
+    io_uring_sqe* acquireSqe();
+    void armAccept();
+    void armWake(int wakeFd);
+    void armRecv(int socket, uint32_t generation);
+    bool setupBufferRing();
+    bool probeBufferRing();
+    void provideBuffers(uint16_t firstId, unsigned count);
+    void recycleBuffer(uint16_t bufferId);
+    void handleRecv(const io_uring_cqe& cqe, std::vector<NetEvent>& events);
+    void closeConnection(int socket, std::vector<NetEvent>& events);
+};
+
+// Writes everything a room worker queued during one pass in a single
+// io_uring_enter: one sendmsg per peer gathering its pending packets, so
+// their order is kept. Sends are MSG_DONTWAIT and complete at once: a peer
+// whose socket is full keeps the rest in its backlog, and only a peer that
+// took everything offered is sent its next packets in another round.
+class UringSendBatch : public SendBatch {
+public:
+    bool setup() { return ring.setup(URING_SEND_ENTRIES, IORING_SETUP_COOP_TASKRUN); }
+    void flush() override;
+
+protected:
+    void add(PeerOutput& peer) override;
+
+private:
+    struct Outgoing {
+        PeerOutput* peer = nullptr;
+        bool done = false;
+        size_t offered = 0;
+        iovec iov[URING_MAX_IOV];
+        msghdr message;
+    };
+
+    UringRing ring;
+    std::vector<Outgoing> outgoing;
+    size_t used = 0;
+};
+
+#endif /* URING_HPP */
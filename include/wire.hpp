@@ -0,0 +1,257 @@
+/*
+** EPITECH PROJECT, 2025
+** Tek 2 B-NWP-400-LIL-4-1-jetpack-julien.mars
+** File description:
+** wire.hpp
+*/
+
+#ifndef WIRE_HPP
+#define WIRE_HPP
+
+#include "common.hpp"
+#include <cstdint>
+#include <type_traits>
+
+// Network packet layouts, declared once and shared by every encoder and
+// decoder. Every scalar is little-endian at a fixed byte offset with no
+// padding, whatever the host. A View reads fields in place from a receive
+// buffer and a Writer stores them in place into a send buffer, so nothing is
+// copied into an intermediate struct.
+namespace Wire {
+
+// Carried by every packet header. Bump it whenever a layout below changes.
+constexpr uint16_t VERSION = 2;
+
+template <typename T>
+inline T load(const char* data) {
+    if constexpr (std::is_same<T, float>::value) {
+        uint32_t bits = load<uint32_t>(data);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    } else {
+        static_assert(std::is_integral<T>::value, "wire scalars are integers or float");
+        using Unsigned = typename std::make_unsigned<T>::type;
+        Unsigned value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<Unsigned>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return static_cast<T>(value);
+    }
+}
+
+template <typename T>
+inline void store(char* data, T value) {
+    if constexpr (std::is_same<T, float>::value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        store<uint32_t>(data, bits);
+    } else {
+        static_assert(std::is_integral<T>::value, "wire scalars are integers or float");
+        using Unsigned = typename std::make_unsigned<T>::type;
+        Unsigned bits = static_cast<Unsigned>(value);
+        for (size_t i = 0; i < sizeof(T); i++) {
+            data[i] = static_cast<char>(bits >> (8 * i));
+        }
+    }
+}
+
+// Encoded size of a scalar, or of a nested layout.
+template <typename T, typename = void>
+struct SizeOf {
+    static constexpr size_t value = sizeof(T);
+};
+
+template <typename T>
+struct SizeOf<T, std::void_t<decltype(T::SIZE)>> {
+    static constexpr size_t value = T::SIZE;
+};
+
+template <typename T, size_t Offset>
+struct Field {
+    using Type = T;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t size = sizeof(T);
+};
+
+// Count consecutive elements, either scalars or nested layouts.
+template <typename T, size_t Offset, size_t Count>
+struct ArrayField {
+    using Type = T;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t count = Count;
+    static constexpr size_t stride = SizeOf<T>::value;
+    static constexpr size_t size = stride * Count;
+};
+
+// Places the next field right after Previous, so offsets are never typed
+// by hand.
+template <typename Previous, typename T>
+using Next = Field<T, Previous::offset + Previous::size>;
+
+template <typename Previous, typename T, size_t Count>
+using NextArray = ArrayField<T, Previous::offset + Previous::size, Count>;
+
+// The field table of a layout: checked at compile time to start at zero
+// and to leave no gap or overlap, and gives the encoded size.
+template <typename... Fields>
+struct Table {
+    static constexpr bool contiguous() {
+        size_t offsets[] = {Fields::offset...};
+        size_t sizes[] = {Fields::size...};
+        size_t end = 0;
+        for (size_t i = 0; i < sizeof...(Fields); i++) {
+            if (offsets[i] != end) {
+                return false;
+            }
+            end += sizes[i];
+        }
+        return true;
+    }
+
+    static constexpr size_t SIZE = (Fields::size + ...);
+    static_assert(contiguous(), "wire fields must be listed in order without gaps");
+};
+
+template <typename Layout>
+class View {
+public:
+    explicit View(const char* data) : data(data) {}
+
+    template <typename F>
+    typename F::Type get() const {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        return load<typename F::Type>(data + F::offset);
+    }
+
+    template <typename F>
+    typename F::Type get(size_t index) const {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        return load<typename F::Type>(data + F::offset + index * F::stride);
+    }
+
+    template <typename F>
+    View<typename F::Type> at(size_t index) const {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        return View<typename F::Type>(data + F::offset + index * F::stride);
+    }
+
+private:
+    const char* data;
+};
+
+template <typename Layout>
+class Writer {
+public:
+    explicit Writer(char* data) : data(data) {}
+
+    template <typename F>
+    void set(typename F::Type value) {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        store<typename F::Type>(data + F::offset, value);
+    }
+
+    template <typename F>
+    void set(size_t index, typename F::Type value) {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        store<typename F::Type>(data + F::offset + index * F::stride, value);
+    }
+
+    template <typename F>
+    Writer<typename F::Type> at(size_t index) {
+        static_assert(F::offset + F::size <= Layout::SIZE, "field outside of layout");
+        return Writer<typename F::Type>(data + F::offset + index * F::stride);
+    }
+
+private:
+    char* data;
+};
+
+struct HeaderLayout {
+    using Type = Field<uint16_t, 0>;
+    using Version = Next<Type, uint16_t>;
+    using Length = Next<Version, uint32_t>;
+    static constexpr size_t SIZE = Table<Type, Version, Length>::SIZE;
+};
+
+// ASSIGN_PLAYER_ID and WAITING_STATUS.
+struct IntLayout {
+    using Value = Field<int32_t, 0>;
+    static constexpr size_t SIZE = Table<Value>::SIZE;
+};
+
+struct PlayerPositionLayout {
+    using PlayerId = Field<int32_t, 0>;
+    using X = Next<PlayerId, float>;
+    using Y = Next<X, float>;
+    using JetpackOn = Next<Y, uint8_t>;
+    static constexpr size_t SIZE = Table<PlayerId, X, Y, JetpackOn>::SIZE;
+};
+
+struct PlayerStateLayout {
+    using Id = Field<int32_t, 0>;
+    using X = Next<Id, float>;
+    using Y = Next<X, float>;
+    using Score = Next<Y, int32_t>;
+    using Alive = Next<Score, uint8_t>;
+    using JetpackOn = Next<Alive, uint8_t>;
+    static constexpr size_t SIZE = Table<Id, X, Y, Score, Alive, JetpackOn>::SIZE;
+};
+
+// Only the first Count player records are sent: each client gets the
+// players in its area of interest, so SIZE is the largest possible payload.
+struct GameStateLayout {
+    using State = Field<uint8_t, 0>;
+    using Count = Next<State, uint8_t>;
+    using Players = NextArray<Count, PlayerStateLayout, MAX_PLAYERS>;
+    static constexpr size_t SIZE = Table<State, Count, Players>::SIZE;
+
+    static constexpr size_t sizeFor(size_t count) {
+        return Players::offset + count * Players::stride;
+    }
+};
+
+struct LeaderboardEntryLayout {
+    using Score = Field<int32_t, 0>;
+    using Alive = Next<Score, uint8_t>;
+    static constexpr size_t SIZE = Table<Score, Alive>::SIZE;
+};
+
+// Every player's score and status, sent to everyone at a lower rate than
+// GAME_STATE so distant players still show up correctly in the rankings.
+struct LeaderboardLayout {
+    using Entries = ArrayField<LeaderboardEntryLayout, 0, MAX_PLAYERS>;
+    static constexpr size_t SIZE = Table<Entries>::SIZE;
+};
+
+struct GameOverLayout {
+    using WinnerId = Field<int32_t, 0>;
+    using Scores = NextArray<WinnerId, int32_t, MAX_PLAYERS>;
+    static constexpr size_t SIZE = Table<WinnerId, Scores>::SIZE;
+};
+
+// The server pings each player in a match a few times a second. SentUs is
+// the server's clock, echoed back untouched in a PONG; the rest is what the
+// server measured for this client so far, shown in its debug overlay.
+// RttUs is 0 until the first PONG came back.
+struct PingLayout {
+    using SentUs = Field<uint64_t, 0>;
+    using RttUs = Next<SentUs, uint32_t>;
+    using JitterUs = Next<RttUs, uint32_t>;
+    using SnapshotInterval = Next<JitterUs, uint8_t>;
+    static constexpr size_t SIZE = Table<SentUs, RttUs, JitterUs, SnapshotInterval>::SIZE;
+};
+
+struct PongLayout {
+    using SentUs = Field<uint64_t, 0>;
+    static constexpr size_t SIZE = Table<SentUs>::SIZE;
+};
+
+// Editing a layout trips these; update them together with VERSION.
+static_assert(HeaderLayout::SIZE == 8, "header layout changed");
+static_assert(PlayerStateLayout::SIZE == 18, "player state layout changed");
+static_assert(GameStateLayout::SIZE == 2 + 18 * MAX_PLAYERS, "game state layout changed");
+
+}
+
+#endif /* WIRE_HPP */
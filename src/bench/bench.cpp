@@ -0,0 +1,127 @@
+#include "bench.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> allocCount{0};
+    std::atomic<uint64_t> allocBytes{0};
+
+    void* countedAlloc(size_t size) {
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+        void* ptr = std::malloc(size ? size : 1);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+void BenchRunner::run(const std::string& name, int64_t size, const Body& body) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    auto timeBatch = [&body](uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const double minTimeNs = minTimeMs * 1e6;
+    uint64_t iterations = 1;
+    double elapsed = timeBatch(iterations);
+    while (elapsed < minTimeNs && iterations < (1ull << 40)) {
+        double scale = elapsed > 0 ? minTimeNs / elapsed * 1.2 : 10.0;
+        if (scale > 10.0) {
+            scale = 10.0;
+        }
+        iterations = static_cast<uint64_t>(iterations * scale) + 1;
+        elapsed = timeBatch(iterations);
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.iterations = iterations;
+    result.nsPerOp = elapsed / iterations;
+    for (int round = 0; round < 2; round++) {
+        uint64_t countBefore = allocCount.load(std::memory_order_relaxed);
+        uint64_t bytesBefore = allocBytes.load(std::memory_order_relaxed);
+        double roundNs = timeBatch(iterations) / iterations;
+        if (roundNs < result.nsPerOp) {
+            result.nsPerOp = roundNs;
+        }
+        result.allocsPerOp = static_cast<double>(allocCount.load(std::memory_order_relaxed) - countBefore) / iterations;
+        result.bytesPerOp = static_cast<double>(allocBytes.load(std::memory_order_relaxed) - bytesBefore) / iterations;
+    }
+    results.push_back(result);
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(10) << size
+              << std::setw(14) << iterations << std::fixed << std::setprecision(1)
+              << std::setw(14) << result.nsPerOp << " ns/op" << std::setprecision(2)
+              << std::setw(10) << result.allocsPerOp << " allocs/op" << std::setprecision(0)
+              << std::setw(12) << result.bytesPerOp << " B/op" << std::endl;
+}
+
+void BenchRunner::expectNoAllocations(const std::string& name, uint64_t iterations, const Body& body) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    uint64_t countBefore = allocCount.load(std::memory_order_relaxed);
+    uint64_t bytesBefore = allocBytes.load(std::memory_order_relaxed);
+    body(iterations);
+    uint64_t count = allocCount.load(std::memory_order_relaxed) - countBefore;
+    uint64_t bytes = allocBytes.load(std::memory_order_relaxed) - bytesBefore;
+
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(24) << iterations
+              << std::setw(14) << count << " allocs" << std::setw(12) << bytes << " B"
+              << (count == 0 ? "" : "  ÉCHEC: aucune allocation attendue") << std::endl;
+    if (count != 0) {
+        failures++;
+    }
+}
+
+void BenchRunner::check(const std::string& name, const Check& body) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    std::string error = body();
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(24)
+              << (error.empty() ? "ok" : "ÉCHEC: " + error) << std::endl;
+    if (!error.empty()) {
+        failures++;
+    }
+}
+
+bool BenchRunner::writeJson(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Impossible d'écrire " << filename << std::endl;
+        return false;
+    }
+
+    file << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"min_time_ms\": " << minTimeMs
+         << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        file << "    {\"name\": \"" << result.name << "\", \"size\": " << result.size
+             << ", \"iterations\": " << result.iterations << std::fixed << std::setprecision(3)
+             << ", \"ns_per_op\": " << result.nsPerOp << ", \"allocs_per_op\": " << result.allocsPerOp
+             << ", \"bytes_per_op\": " << result.bytesPerOp << "}" << (i + 1 < results.size() ? "," : "")
+             << "\n";
+    }
+    file << "  ]\n}\n";
+    return static_cast<bool>(file);
+}
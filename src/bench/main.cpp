@@ -0,0 +1,576 @@
+#include "bench.hpp"
+#include "fanout.hpp"
+#include "interest.hpp"
+#include "link_quality.hpp"
+#include "map.hpp"
+#include "protocol.hpp"
+#include "room.hpp"
+#include "simulation.hpp"
+#include "timer_wheel.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+namespace {
+    const int MAP_HEIGHT = 10;
+    const int MAP_WIDTHS[] = {100, 1000, 10000, 100000};
+
+    // Same shape as maps/basic.map: a band of coins and scattered zappers.
+    std::string makeMapRows(int width) {
+        std::string rows;
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            for (int x = 0; x < width; x++) {
+                char cell = '_';
+                if (y >= 2 && y <= 4 && x % 5 == 0 && x > 10) {
+                    cell = 'c';
+                } else if (y == 7 && x % 23 == 0 && x > 10) {
+                    cell = 'e';
+                }
+                rows += cell;
+            }
+            rows += '\n';
+        }
+        return rows;
+    }
+
+    std::string makeMapString(int width) {
+        return std::to_string(width) + "," + std::to_string(MAP_HEIGHT) + "\n" + makeMapRows(width);
+    }
+
+    void benchMap(BenchRunner& runner) {
+        for (int width : MAP_WIDTHS) {
+            std::string mapString = makeMapString(width);
+            runner.run("map.fromString", width * MAP_HEIGHT, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    Map map;
+                    map.fromString(mapString);
+                    benchKeep(map);
+                }
+            });
+
+            Map map;
+            map.fromString(mapString);
+            runner.run("map.toString", width * MAP_HEIGHT, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    std::string result = map.toString();
+                    benchKeep(result);
+                }
+            });
+
+            char path[] = "/tmp/jetpack_bench_XXXXXX";
+            int fd = mkstemp(path);
+            if (fd < 0) {
+                std::cerr << "Impossible de créer un fichier temporaire" << std::endl;
+                continue;
+            }
+            std::string rows = makeMapRows(width);
+            bool written = write(fd, rows.data(), rows.size()) == static_cast<ssize_t>(rows.size());
+            close(fd);
+            if (written) {
+                runner.run("map.loadFromFile", width * MAP_HEIGHT, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        Map loaded;
+                        loaded.loadFromFile(path);
+                        benchKeep(loaded);
+                    }
+                });
+            }
+            unlink(path);
+        }
+    }
+
+    // One op is a full GAME_STATE round trip: encode and send on one end of
+    // a socketpair, receive and decode on the other, as ClientSession does.
+    void benchProtocol(BenchRunner& runner) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+            std::cerr << "socketpair: " << strerror(errno) << std::endl;
+            return;
+        }
+
+        std::array<Player, MAX_PLAYERS> players;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            players[i].id = i;
+            players[i].position = Vector2(64.0f * i, 100.0f);
+            players[i].score = i;
+        }
+
+        runner.run("protocol.gameState", MAX_PLAYERS, [&](uint64_t iterations) {
+            char buffer[MAX_BUFFER_SIZE];
+            std::array<Player, MAX_PLAYERS> decoded;
+            for (uint64_t i = 0; i < iterations; i++) {
+                players[0].position.x = static_cast<float>(i);
+                Protocol::sendGameState(fds[0], RUNNING, players);
+
+                int packetType;
+                int dataSize = Protocol::receivePacket(fds[1], packetType, buffer, MAX_BUFFER_SIZE);
+                using Layout = Wire::GameStateLayout;
+                using PlayerLayout = Wire::PlayerStateLayout;
+                Wire::View<Layout> state(buffer);
+                int count = dataSize >= (int)Layout::sizeFor(0) ? state.get<Layout::Count>() : 0;
+                for (int p = 0; p < count && dataSize >= (int)Layout::sizeFor(count); p++) {
+                    Wire::View<PlayerLayout> playerData = state.at<Layout::Players>(p);
+                    decoded[p].id = playerData.get<PlayerLayout::Id>();
+                    decoded[p].position.x = playerData.get<PlayerLayout::X>();
+                    decoded[p].position.y = playerData.get<PlayerLayout::Y>();
+                    decoded[p].score = playerData.get<PlayerLayout::Score>();
+                    decoded[p].alive = playerData.get<PlayerLayout::Alive>() != 0;
+                    decoded[p].jetpackOn = playerData.get<PlayerLayout::JetpackOn>() != 0;
+                }
+                benchKeep(decoded);
+            }
+        });
+
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void benchSimulation(BenchRunner& runner) {
+        for (int width : MAP_WIDTHS) {
+            Map map;
+            map.fromString(makeMapString(width));
+
+            Simulation simulation;
+            simulation.start(map, 0);
+            runner.run("simulation.checkCollisions", width * MAP_HEIGHT, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    simulation.checkCollisions(i % MAX_PLAYERS);
+                }
+            });
+
+            // Restarting a finished match is part of the timed loop; it happens
+            // once every width * 8 ticks so it barely shows in ns/op.
+            simulation.start(map, 0);
+            runner.run("simulation.updateGameState", width * MAP_HEIGHT, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    if (simulation.getState() != RUNNING) {
+                        simulation.start(map, 0);
+                    }
+                    simulation.setJetpack(0, (i / 20) % 2 == 0);
+                    simulation.setJetpack(1, (i / 30) % 2 == 0);
+                    simulation.updateGameState();
+                }
+            });
+        }
+    }
+
+    // Keeps what a tick queued until the end of the pass, then drops it:
+    // a room worker's batch without the sends.
+    class HeldSendBatch : public SendBatch {
+    public:
+        HeldSendBatch() { held.reserve(MAX_PLAYERS); }
+        void flush() override {
+            for (PeerOutput* peer : held) {
+                peer->batched = false;
+                peer->backlog.clear();
+            }
+            held.clear();
+        }
+
+    protected:
+        void add(PeerOutput& peer) override { held.push_back(&peer); }
+
+    private:
+        std::vector<PeerOutput*> held;
+    };
+
+    // A match as the server runs it when it is the featured one: every
+    // player sends an input each tick and one spectator watches. A finished
+    // match is replaced by a new one on fresh sockets.
+    class BenchMatch {
+    public:
+        explicit BenchMatch(const Map& map) : map(map) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0) {
+                spectatorPeer = fds[1];
+                feed.join(fds[0]);
+            }
+            using Layout = Wire::PlayerPositionLayout;
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                Wire::Writer<Layout>(inputs[i].data()).set<Layout::PlayerId>(i);
+            }
+            start();
+        }
+
+        ~BenchMatch() {
+            stop();
+            fanOut.closeAll();
+            if (spectatorPeer >= 0) {
+                close(spectatorPeer);
+            }
+        }
+
+        bool start() {
+            stop();
+            std::array<int, MAX_PLAYERS> sockets;
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                int fds[2];
+                if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+                    std::cerr << "socketpair: " << strerror(errno) << std::endl;
+                    return false;
+                }
+                sockets[i] = fds[0];
+                peers[i] = fds[1];
+            }
+            room = std::make_unique<Room>(nextId++, map, sockets, metrics);
+            room->feature(&feed);
+            room->start();
+            return true;
+        }
+
+        void tick(uint64_t i) {
+            using Layout = Wire::PlayerPositionLayout;
+            for (int p = 0; p < MAX_PLAYERS; p++) {
+                bool jetpackOn = jetpack && (i / (20 + 10 * p)) % 2 == 0;
+                Wire::Writer<Layout>(inputs[p].data()).set<Layout::JetpackOn>(jetpackOn ? 1 : 0);
+                room->handlePacket(p, PLAYER_POS, inputs[p].data(), Layout::SIZE);
+            }
+            bool running = room->tick(out);
+            out.flush();
+            if (i % 64 == 0) {
+                char discarded[MAX_BUFFER_SIZE];
+                while (recv(spectatorPeer, discarded, sizeof(discarded), MSG_DONTWAIT) > 0) {
+                }
+            }
+            if (!running) {
+                start();
+            }
+        }
+
+        void setJetpack(bool enabled) { jetpack = enabled; }
+
+    private:
+        Map map;
+        ServerMetrics metrics;
+        FanOut fanOut{1, MAX_SPECTATOR_BACKLOG, metrics.spectators};
+        SpectatorFeed feed{fanOut};
+        HeldSendBatch out;
+        std::unique_ptr<Room> room;
+        std::array<int, MAX_PLAYERS> peers{};
+        std::array<std::array<char, Wire::PlayerPositionLayout::SIZE>, MAX_PLAYERS> inputs{};
+        int spectatorPeer = -1;
+        int nextId = 0;
+        bool jetpack = true;
+
+        void stop() {
+            if (!room) {
+                return;
+            }
+            room->closeSockets();
+            for (int peer : peers) {
+                close(peer);
+            }
+            room.reset();
+        }
+    };
+
+    // room.tick includes the occasional new match once one ends. The check
+    // runs on a map without zappers and with nobody flying, so the match
+    // cannot end under it: once warmed up, ticking must not touch the heap.
+    void benchRoom(BenchRunner& runner) {
+        const int width = 1000;
+        Map map;
+        map.fromString(makeMapString(width));
+        BenchMatch match(map);
+        runner.run("room.tick", MAX_PLAYERS, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                match.tick(i);
+            }
+        });
+
+        std::string safeRows = makeMapString(width);
+        std::replace(safeRows.begin(), safeRows.end(), 'e', '_');
+        Map safeMap;
+        safeMap.fromString(safeRows);
+        BenchMatch steady(safeMap);
+        steady.setJetpack(false);
+        const uint64_t warmupTicks = Simulation::GRACE_TICKS + 2 * LEADERBOARD_TICKS;
+        for (uint64_t i = 0; i < warmupTicks; i++) {
+            steady.tick(i);
+        }
+        runner.expectNoAllocations("room.tick.steady", 2000, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                steady.tick(warmupTicks + i);
+            }
+        });
+    }
+}
+
+namespace {
+    // Drives a TimerWheel and a plain multimap of expiry times with the same
+    // random schedules, cancels and advances, including callbacks that
+    // schedule and cancel in turn. Each advance must fire exactly the
+    // timers due by then, in expiry order, and timeoutMs() must never let a
+    // poll sleep past the next one.
+    class TimerWheelModel {
+    public:
+        explicit TimerWheelModel(uint32_t seed) : random(seed) {}
+
+        std::string run(int steps) {
+            for (int step = 0; step < steps && error.empty(); step++) {
+                uint32_t action = random() % 100;
+                if (action < 45) {
+                    schedule(nowMs, randomDelay());
+                } else if (action < 65) {
+                    cancelRandom();
+                } else {
+                    advance();
+                }
+            }
+            // Everything left must still come out, the longest delays last.
+            while (error.empty() && !pending.empty()) {
+                advanceTo(pending.begin()->first + random() % 100);
+            }
+            if (error.empty() && wheel.size() != 0) {
+                error = "minuteries restantes après la dernière échéance";
+            }
+            return error;
+        }
+
+    private:
+        static constexpr int64_t MAX_DELAY = (int64_t(1) << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+
+        struct Entry {
+            TimerWheel::Id id = 0;
+            int64_t expiresMs = 0;
+        };
+
+        std::mt19937 random;
+        TimerWheel wheel{0};
+        int64_t nowMs = 0;
+        int64_t previousMs = 0;
+        int64_t lastFiredMs = 0;
+        std::multimap<int64_t, uint64_t> pending;
+        std::vector<Entry> entries;
+        std::string error;
+
+        // Every level of the wheel, a few delays past its span, and some
+        // the wheel has to clamp.
+        int64_t randomDelay() {
+            switch (random() % 6) {
+                case 0: return random() % 3;
+                case 1: return random() % 64;
+                case 2: return random() % 4096;
+                case 3: return random() % 262144;
+                case 4: return random() % (MAX_DELAY + 1);
+                default: return MAX_DELAY + random() % 1000;
+            }
+        }
+
+        void schedule(int64_t baseMs, int64_t delayMs) {
+            uint64_t key = entries.size();
+            Entry entry;
+            entry.expiresMs = baseMs + std::clamp<int64_t>(delayMs, 1, MAX_DELAY);
+            entry.id = wheel.schedule(delayMs, [this, key]() { fire(key); });
+            entries.push_back(entry);
+            pending.emplace(entry.expiresMs, key);
+        }
+
+        bool erasePending(uint64_t key) {
+            auto range = pending.equal_range(entries[key].expiresMs);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == key) {
+                    pending.erase(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Any id ever handed out, fired and cancelled ones included.
+        void cancelRandom() {
+            if (entries.empty()) {
+                return;
+            }
+            uint64_t key = random() % entries.size();
+            bool expected = erasePending(key);
+            if (wheel.cancel(entries[key].id) != expected) {
+                error = "cancel() a répondu " + std::string(expected ? "false" : "true")
+                    + " pour la minuterie " + std::to_string(key);
+            }
+        }
+
+        void fire(uint64_t key) {
+            int64_t expiresMs = entries[key].expiresMs;
+            if (!erasePending(key)) {
+                error = "minuterie " + std::to_string(key) + " déclenchée deux fois ou après son annulation";
+                return;
+            }
+            if (expiresMs <= previousMs || expiresMs > nowMs) {
+                error = "minuterie " + std::to_string(key) + " due à " + std::to_string(expiresMs)
+                    + " ms déclenchée entre " + std::to_string(previousMs) + " et " + std::to_string(nowMs) + " ms";
+                return;
+            }
+            if (expiresMs < lastFiredMs) {
+                error = "minuterie " + std::to_string(key) + " déclenchée dans le désordre";
+                return;
+            }
+            lastFiredMs = expiresMs;
+            // The wheel is at the expiry time while its callbacks run.
+            uint32_t action = random() % 10;
+            if (action < 3) {
+                schedule(expiresMs, randomDelay() % 128);
+            } else if (action < 4) {
+                cancelRandom();
+            }
+        }
+
+        void advance() {
+            uint32_t kind = random() % 10;
+            if (kind < 6) {
+                advanceTo(nowMs + 1 + random() % 4);
+            } else if (kind < 9) {
+                advanceTo(nowMs + random() % 5000);
+            } else {
+                advanceTo(nowMs + random() % (MAX_DELAY / 8));
+            }
+        }
+
+        void advanceTo(int64_t targetMs) {
+            if (!pending.empty()) {
+                int64_t untilNext = pending.begin()->first - nowMs;
+                int timeout = wheel.timeoutMs(nowMs, POLL_TIMEOUT);
+                if (timeout < 0 || (untilNext >= 0 && timeout > untilNext)) {
+                    error = "timeoutMs() a rendu " + std::to_string(timeout) + " ms, prochaine échéance dans "
+                        + std::to_string(untilNext) + " ms";
+                    return;
+                }
+            }
+            previousMs = nowMs;
+            nowMs = std::max(nowMs, targetMs);
+            lastFiredMs = previousMs;
+            wheel.advance(nowMs);
+            if (error.empty() && !pending.empty() && pending.begin()->first <= nowMs) {
+                error = "minuterie " + std::to_string(pending.begin()->second) + " due à "
+                    + std::to_string(pending.begin()->first) + " ms pas déclenchée à " + std::to_string(nowMs) + " ms";
+            }
+            if (error.empty() && wheel.size() != pending.size()) {
+                error = "size() vaut " + std::to_string(wheel.size()) + " au lieu de " + std::to_string(pending.size());
+            }
+        }
+    };
+
+    // A viewer far from the other player must still see it in one of every
+    // INTEREST_DISTANT_TICKS snapshots, at every snapshot interval and slot.
+    std::string checkDistantCadence(int interval, int slot) {
+        LinkQuality link;
+        for (int step = 1; step < interval; step++) {
+            link.adapt(SEND_QUEUE_DEGRADE_BYTES + 1);
+        }
+        if (link.getSnapshotInterval() != interval) {
+            return "intervalle " + std::to_string(link.getSnapshotInterval()) + " au lieu de " + std::to_string(interval);
+        }
+        std::array<Player, MAX_PLAYERS> players;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            players[i].id = i;
+            players[i].position = Vector2(i == slot ? 0.0f : 100.0f * INTEREST_COLUMN_WIDTH, 100.0f);
+        }
+        InterestGrid grid;
+        grid.build(players);
+        int column = InterestGrid::columnOf(players[slot].position.x);
+
+        std::vector<int> visible;
+        std::array<int, MAX_PLAYERS> unseenFor{};
+        for (uint32_t tick = 0; tick < 4 * INTEREST_DISTANT_TICKS * MAX_SNAPSHOT_INTERVAL; tick++) {
+            if (!link.sendsSnapshotOn(tick, slot)) {
+                continue;
+            }
+            grid.select(column, link.snapshotCount(tick), visible);
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                bool seen = std::find(visible.begin(), visible.end(), i) != visible.end();
+                unseenFor[i] = seen ? 0 : unseenFor[i] + 1;
+                if (unseenFor[i] >= INTEREST_DISTANT_TICKS) {
+                    return "intervalle " + std::to_string(interval) + ", place " + std::to_string(slot)
+                        + ": joueur " + std::to_string(i) + " absent de " + std::to_string(unseenFor[i])
+                        + " snapshots d'affilée";
+                }
+            }
+        }
+        return std::string();
+    }
+
+    void benchInterest(BenchRunner& runner) {
+        runner.check("interest.distant_cadence", []() {
+            for (int interval = 1; interval <= MAX_SNAPSHOT_INTERVAL; interval++) {
+                for (int slot = 0; slot < MAX_PLAYERS; slot++) {
+                    std::string error = checkDistantCadence(interval, slot);
+                    if (!error.empty()) {
+                        return error;
+                    }
+                }
+            }
+            return std::string();
+        });
+    }
+
+    void benchTimerWheel(BenchRunner& runner) {
+        runner.check("timer_wheel.model", []() {
+            for (uint32_t seed = 1; seed <= 20; seed++) {
+                std::string error = TimerWheelModel(seed).run(20000);
+                if (!error.empty()) {
+                    return "graine " + std::to_string(seed) + ": " + error;
+                }
+            }
+            return std::string();
+        });
+
+        // A lobby's worth of keepalives and idle timers, each rearmed as it
+        // is cancelled.
+        const int PENDING = 10000;
+        TimerWheel wheel(0);
+        std::vector<TimerWheel::Id> ids(PENDING);
+        for (int i = 0; i < PENDING; i++) {
+            ids[i] = wheel.schedule(1000 + i % 10000, []() {});
+        }
+        runner.run("timer_wheel.rearm", PENDING, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                TimerWheel::Id& id = ids[i % PENDING];
+                wheel.cancel(id);
+                id = wheel.schedule(1000 + i % 10000, []() {});
+            }
+        });
+    }
+}
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [-o <file>] [-f <filter>] [-t <ms>]" << std::endl;
+    std::cout << "  -o <file>    Write the results as JSON to this file" << std::endl;
+    std::cout << "  -f <filter>  Only run benchmarks whose name contains <filter>" << std::endl;
+    std::cout << "  -t <ms>      Minimum duration of a measured batch (default 200)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchRunner runner;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-o" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "-f" && i + 1 < argc) {
+            runner.setFilter(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            runner.setMinTimeMs(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    benchMap(runner);
+    benchProtocol(runner);
+    benchSimulation(runner);
+    benchRoom(runner);
+    benchInterest(runner);
+    benchTimerWheel(runner);
+
+    if (!outputFile.empty() && !runner.writeJson(outputFile)) {
+        return 1;
+    }
+    return runner.passed() ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "bot.hpp"
+#include <chrono>
+
+Bot::Bot(const std::string& serverIP, int port)
+    : session(serverIP, port), rng(std::random_device{}()) {
+}
+
+bool Bot::loadScript(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Impossible d'ouvrir le script: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    script.clear();
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        int ticks = 0;
+        std::string action;
+        if (!(stream >> ticks >> action) || ticks <= 0 || (action != "on" && action != "off")) {
+            std::cerr << "Ligne de script invalide: " << line << std::endl;
+            return false;
+        }
+        script.push_back({ticks, action == "on"});
+    }
+
+    if (script.empty()) {
+        std::cerr << "Script vide: " << filename << std::endl;
+        return false;
+    }
+    scriptIndex = 0;
+    stepTicksLeft = script[0].ticks;
+    return true;
+}
+
+void Bot::setRandomPolicy(unsigned int seed, float chance) {
+    script.clear();
+    rng.seed(seed);
+    toggleChance = chance;
+}
+
+bool Bot::nextInput() {
+    if (script.empty()) {
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        return dist(rng) < toggleChance ? !jetpackOn : jetpackOn;
+    }
+
+    if (stepTicksLeft <= 0) {
+        scriptIndex = (scriptIndex + 1) % script.size();
+        stepTicksLeft = script[scriptIndex].ticks;
+    }
+    stepTicksLeft--;
+    return script[scriptIndex].jetpackOn;
+}
+
+bool Bot::run() {
+    if (!session.connect()) {
+        return false;
+    }
+
+    const std::chrono::microseconds TICK_DURATION(1000000 / 60);
+    auto startTime = std::chrono::steady_clock::now();
+    auto nextTick = startTime + TICK_DURATION;
+
+    while (session.isConnected()) {
+        auto now = std::chrono::steady_clock::now();
+        int timeoutMs = 0;
+        if (nextTick > now) {
+            timeoutMs = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now).count();
+        }
+
+        if (session.poll(timeoutMs) < 0) {
+            break;
+        }
+
+        const ClientSnapshot& state = session.state();
+        if (state.gameState == OVER) {
+            outcome.finished = true;
+            break;
+        }
+
+        if (std::chrono::steady_clock::now() < nextTick) {
+            continue;
+        }
+        nextTick += TICK_DURATION;
+
+        if (state.gameState != RUNNING || state.myPlayerId < 0 || state.myPlayerId >= MAX_PLAYERS ||
+            !state.players[state.myPlayerId].alive) {
+            continue;
+        }
+
+        outcome.ticksAlive++;
+        bool wanted = nextInput();
+        if (wanted != jetpackOn) {
+            jetpackOn = wanted;
+            outcome.jetpackToggles++;
+            session.sendPlayerPosition(state, jetpackOn);
+            LOG_DEBUG("[BOT] Jetpack " << (jetpackOn ? "on" : "off"));
+        }
+    }
+
+    outcome.durationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    recordOutcome();
+    session.disconnect();
+    return outcome.finished;
+}
+
+void Bot::recordOutcome() {
+    const ClientSnapshot& state = session.state();
+
+    outcome.playerId = state.myPlayerId;
+    outcome.winnerId = state.winnerId;
+    if (state.myPlayerId >= 0 && state.myPlayerId < MAX_PLAYERS) {
+        outcome.score = state.players[state.myPlayerId].score;
+    }
+}
+
+bool Bot::writeOutcome(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::app);
+    if (!file) {
+        std::cerr << "Impossible d'écrire le résultat: " << filename << std::endl;
+        return false;
+    }
+
+    file << "{\"finished\":" << (outcome.finished ? "true" : "false")
+         << ",\"player_id\":" << outcome.playerId
+         << ",\"winner_id\":" << outcome.winnerId
+         << ",\"won\":" << (outcome.finished && outcome.winnerId == outcome.playerId ? "true" : "false")
+         << ",\"score\":" << outcome.score
+         << ",\"ticks_alive\":" << outcome.ticksAlive
+         << ",\"jetpack_toggles\":" << outcome.jetpackToggles
+         << ",\"duration_s\":" << outcome.durationSeconds << "}\n";
+    return true;
+}
@@ -0,0 +1,80 @@
+#include "bot.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -h <ip> -p <port> [-s <script> | -r <seed>] [-t <chance>] [-k <rating>] [-o <file>] [-d]" << std::endl;
+    std::cout << "  -h <ip>      IP address of the server" << std::endl;
+    std::cout << "  -p <port>    Port of the server" << std::endl;
+    std::cout << "  -s <script>  Play a looping script of '<ticks> on|off' lines" << std::endl;
+    std::cout << "  -r <seed>    Play a random policy with the given seed (default)" << std::endl;
+    std::cout << "  -t <chance>  Per-tick probability of toggling the jetpack (random policy)" << std::endl;
+    std::cout << "  -k <rating>  Skill rating announced to the matchmaker" << std::endl;
+    std::cout << "  -o <file>    Append the match outcome as a JSON line to this file" << std::endl;
+    std::cout << "  -d           Enable debug mode" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string serverIP = "127.0.0.1";
+    int port = 0;
+    std::string scriptFile;
+    std::string outputFile;
+    unsigned int seed = std::random_device{}();
+    float toggleChance = 0.05f;
+    int skillRating = -1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" && i + 1 < argc) {
+            serverIP = argv[++i];
+        } else if (arg == "-p" && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (arg == "-s" && i + 1 < argc) {
+            scriptFile = argv[++i];
+        } else if (arg == "-r" && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "-t" && i + 1 < argc) {
+            toggleChance = std::atof(argv[++i]);
+        } else if (arg == "-k" && i + 1 < argc) {
+            skillRating = std::atoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "-d") {
+            debug_mode = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (port <= 0) {
+        std::cerr << "Missing required arguments!" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Bot bot(serverIP, port);
+    bot.setSkillRating(skillRating);
+
+    if (!scriptFile.empty()) {
+        if (!bot.loadScript(scriptFile)) {
+            return 1;
+        }
+    } else {
+        bot.setRandomPolicy(seed, toggleChance);
+    }
+
+    bool finished = bot.run();
+    const BotOutcome& outcome = bot.getOutcome();
+    std::cout << "Bot " << outcome.playerId << ": " << (finished ? "match terminé" : "match interrompu")
+              << ", score " << outcome.score << ", gagnant " << outcome.winnerId
+              << ", " << outcome.ticksAlive << " ticks en vie" << std::endl;
+
+    if (!outputFile.empty() && !bot.writeOutcome(outputFile)) {
+        return 1;
+    }
+    return finished ? 0 : 2;
+}
@@ -0,0 +1,79 @@
+#include "asset_loader.hpp"
+#include "profiler.hpp"
+
+AssetLoader::~AssetLoader() {
+    stop();
+}
+
+void AssetLoader::submit(const std::string& name, Decode decode, Finish finish) {
+    jobs.push_back({name, std::move(decode), std::move(finish), false});
+}
+
+void AssetLoader::start(int workerCount) {
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    if (static_cast<size_t>(workerCount) > jobs.size()) {
+        workerCount = jobs.size();
+    }
+    ready.reserve(jobs.size());
+    readyLocal.reserve(jobs.size());
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+void AssetLoader::stop() {
+    stopping = true;
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+void AssetLoader::workerLoop() {
+    Profiler::instance().setThreadName("assets");
+    while (!stopping) {
+        size_t index = nextJob.fetch_add(1, std::memory_order_relaxed);
+        if (index >= jobs.size()) {
+            return;
+        }
+        Job& job = jobs[index];
+        {
+            PROFILE_SCOPE("asset.decode");
+            job.ok = job.decode();
+        }
+        std::lock_guard<std::mutex> lock(readyMutex);
+        ready.push_back(index);
+    }
+}
+
+int AssetLoader::poll() {
+    if (isDone()) {
+        return 0;
+    }
+    readyLocal.clear();
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        readyLocal.swap(ready);
+    }
+
+    for (size_t index : readyLocal) {
+        Job& job = jobs[index];
+        if (job.ok) {
+            if (job.finish) {
+                job.finish();
+            }
+            LOG_DEBUG("Asset prêt: " << job.name);
+        } else {
+            std::cerr << "Erreur lors du chargement de l'asset: " << job.name << std::endl;
+        }
+        finished++;
+    }
+    if (isDone()) {
+        stop();
+    }
+    return readyLocal.size();
+}
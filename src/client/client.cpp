@@ -5,11 +5,11 @@
 #include <math.h>
 
 Client::Client(const std::string& serverIP, int port)
-   : serverIP(serverIP), port(port), gameState(WAITING), waitingPlayers(1) {
-   for (int i = 0; i < MAX_PLAYERS; ++i) {
-       players[i].id = i;
-       players[i].alive = true;
-   }
+   : session(serverIP, port) {
+   publishState();
+   frame = &frames.read();
+   renderFrames.publish();
+   view = &renderFrames.read();
 }
 
 Client::~Client() {
@@ -17,45 +17,11 @@ Client::~Client() {
 }
 
 bool Client::connect() {
-    clientSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (clientSocket < 0) {
-        std::cerr << "Erreur lors de la création du socket" << std::endl;
-        return false;
-    }
- 
-    struct sockaddr_in serverAddr;
-    std::memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port);
- 
-    if (inet_pton(AF_INET, serverIP.c_str(), &serverAddr.sin_addr) <= 0) {
-        std::cerr << "Adresse IP invalide: " << serverIP << std::endl;
-        close(clientSocket);
-        clientSocket = -1;
-        return false;
-    }
- 
-    if (::connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "Erreur lors de la connexion au serveur" << std::endl;
-        close(clientSocket);
-        clientSocket = -1;
-        return false;
-    }
- 
-    std::cout << "Connecté au serveur " << serverIP << ":" << port << std::endl;
- 
-    if (!Protocol::sendPacket(clientSocket, READY)) {
-        std::cerr << "Erreur lors de l'envoi du paquet READY" << std::endl;
-        close(clientSocket);
-        clientSocket = -1;
-        return false;
-    }
- 
-    return true;
+    return session.connect();
 }
 
 bool Client::start() {
-    if (clientSocket < 0) {
+    if (!session.isConnected()) {
         std::cerr << "Non connecté au serveur" << std::endl;
         return false;
     }
@@ -69,8 +35,12 @@ bool Client::start() {
     running = true;
 
     try {
+        // Events must be polled on the thread that created the window, so
+        // input stays here and rendering moves to its own thread.
+        window.setActive(false);
         networkThread = std::thread(&Client::networkLoop, this);
-        graphicsLoop(); 
+        graphicsThread = std::thread(&Client::graphicsLoop, this);
+        inputLoop();
     } catch (const std::exception& e) {
         std::cerr << "Erreur lors du démarrage des threads: " << e.what() << std::endl;
         running = false;
@@ -83,6 +53,7 @@ bool Client::start() {
 
 void Client::stop() {
     running = false;
+    assetLoader.stop();
     
     if (networkThread.joinable()) {
         networkThread.join();
@@ -90,12 +61,15 @@ void Client::stop() {
     
     if (graphicsThread.joinable()) {
         graphicsThread.join();
+        window.setActive(true);
     }
-    
-    if (clientSocket >= 0) {
-        close(clientSocket);
-        clientSocket = -1;
+
+    if (!traceFile.empty() && Profiler::instance().writeChromeTrace(traceFile)) {
+        std::cout << "Trace écrite dans " << traceFile << std::endl;
+        traceFile.clear();
     }
+    
+    session.disconnect();
     backgroundMusic.stop();
     if (window.isOpen()) {
         window.close();
@@ -104,62 +78,93 @@ void Client::stop() {
     std::cout << "Client arrêté" << std::endl;
 }
 
+void Client::setSpectator(bool enabled) {
+    session.setSpectator(enabled);
+}
+
+void Client::setTraceFile(const std::string& filename) {
+    traceFile = filename;
+    Profiler::instance().setEnabled(!traceFile.empty() || showOverlay);
+}
+
+void Client::setFramePacing(FramePacing mode, int framesPerSecond) {
+    framePacing = mode;
+    if (framesPerSecond > 0) {
+        targetFps = framesPerSecond;
+    }
+}
+
 void Client::initWindow() {
     sf::ContextSettings settings;
     settings.attributeFlags = sf::ContextSettings::Default;
     window.create(sf::VideoMode(windowWidth, windowHeight), "Jetpack Game", sf::Style::Default, settings);
+    window.setVerticalSyncEnabled(framePacing == PACING_VSYNC);
 }
 
 bool Client::loadAssets() {
-    if (!font.loadFromFile("assets/jetpack_font.ttf")) {
+    if (!assetPack.open(ASSET_PACK_FILE)) {
+        return false;
+    }
+
+    const AssetEntry* fontEntry = assetPack.find("jetpack_font.ttf");
+    if (!fontEntry || !font.loadFromMemory(fontEntry->data, fontEntry->size)) {
         std::cerr << "Erreur lors du chargement de la police" << std::endl;
         return false;
     }
     
-    const std::vector<std::string> textureFiles = {
-        "background",
-        "player_sprite_sheet",
-        "coins_sprite_sheet",
-        "zapper_sprite_sheet"
+    const std::vector<std::pair<TextureId, std::string>> textureFiles = {
+        {TEXTURE_BACKGROUND, "background.png"},
+        {TEXTURE_PLAYER, "player_sprite_sheet.png"},
+        {TEXTURE_COINS, "coins_sprite_sheet.png"},
+        {TEXTURE_ZAPPER, "zapper_sprite_sheet.png"}
     };
     
-    for (const auto& name : textureFiles) {
-        textures[name] = sf::Texture();
-        if (!textures[name].loadFromFile("assets/" + name + ".png")) {
-            std::cerr << "Erreur lors du chargement de la texture: " << name << std::endl;
+    for (const auto& texture : textureFiles) {
+        TextureId id = texture.first;
+        const AssetEntry* entry = assetPack.find(texture.second);
+        if (!entry) {
+            std::cerr << "Texture absente du pack: " << texture.second << std::endl;
             return false;
         }
-        
-        textures[name].setSmooth(false);
-        sprites[name] = sf::Sprite(textures[name]);
-        
-        debugPrint("Texture " + name + " chargée: " + 
-                  std::to_string(textures[name].getSize().x) + "x" + 
-                  std::to_string(textures[name].getSize().y));
-    }
-
-    const std::vector<std::pair<std::string, std::string>> soundFiles = {
-        {"jetpack_start", "jetpack_start.wav"},
-        {"jetpack_loop", "jetpack_lp.wav"},
-        {"jetpack_stop", "jetpack_stop.wav"},
-        {"coin_pickup", "coin_pickup_1.wav"},
-        {"zapper_hit", "dud_zapper_pop.wav"}
+        assetLoader.submit(texture.second,
+            [this, id, entry]() { return images[id].loadFromMemory(entry->data, entry->size); },
+            [this, id]() {
+                textures[id].loadFromImage(images[id]);
+                textures[id].setSmooth(false);
+                sprites[id].setTexture(textures[id], true);
+                images[id] = sf::Image();
+                textureReady[id] = true;
+            });
+    }
+
+    const std::vector<std::pair<SoundId, std::string>> soundFiles = {
+        {SOUND_JETPACK_START, "jetpack_start.wav"},
+        {SOUND_JETPACK_LOOP, "jetpack_lp.wav"},
+        {SOUND_JETPACK_STOP, "jetpack_stop.wav"},
+        {SOUND_COIN_PICKUP, "coin_pickup_1.wav"},
+        {SOUND_ZAPPER_HIT, "dud_zapper_pop.wav"}
     };
     
     for (const auto& sound : soundFiles) {
-        soundBuffers[sound.first] = sf::SoundBuffer();
-        if (!soundBuffers[sound.first].loadFromFile("assets/" + sound.second)) {
-            std::cerr << "Erreur lors du chargement du son: " << sound.second << std::endl;
+        SoundId id = sound.first;
+        const AssetEntry* entry = assetPack.find(sound.second);
+        if (!entry) {
+            std::cerr << "Son absent du pack: " << sound.second << std::endl;
             return false;
         }
+        assetLoader.submit(sound.second,
+            [this, id, entry]() { return sounds.loadFromMemory(id, entry->data, entry->size); },
+            [this, id]() {
+                if (id == SOUND_JETPACK_LOOP) {
+                    jetpackSound.setBuffer(sounds.buffer(id));
+                }
+                sounds.markReady(id);
+            });
     }
-    
-    jetpackSound.setBuffer(soundBuffers["jetpack_loop"]);
     jetpackSound.setLoop(true);
-    coinSound.setBuffer(soundBuffers["coin_pickup"]);
-    zapperSound.setBuffer(soundBuffers["zapper_hit"]);
     
-    if (!backgroundMusic.openFromFile("assets/theme.ogg")) {
+    const AssetEntry* musicEntry = assetPack.find("theme.ogg");
+    if (!musicEntry || !backgroundMusic.openFromMemory(musicEntry->data, musicEntry->size)) {
         std::cerr << "Erreur lors du chargement de la musique de fond" << std::endl;
         return false;
     }
@@ -167,281 +172,200 @@ bool Client::loadAssets() {
     backgroundMusic.setLoop(true);
     backgroundMusic.setVolume(50);
     backgroundMusic.play();
-    
+
+    int workers = std::thread::hardware_concurrency();
+    assetLoader.start(workers > 4 ? 4 : workers);
     return true;
 }
 
-void Client::graphicsLoop() {
-    debugPrint("Thread graphique démarré");
+void Client::inputLoop() {
+    LOG_DEBUG("Thread d'entrée démarré");
+    Profiler::instance().setThreadName("input");
 
-    sf::Clock frameClock;
-    float previousTime = frameClock.getElapsedTime().asSeconds();
-    float accumulatedTime = 0.0f;
     const float fixedTimeStep = 1.0f / 60.0f;
+    const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(fixedTimeStep));
+    auto nextTick = std::chrono::steady_clock::now();
 
     while (running && window.isOpen()) {
-        handleInput();
-
-        float currentTime = frameClock.getElapsedTime().asSeconds();
-        float deltaTime = currentTime - previousTime;
-        previousTime = currentTime;
-
-        if (deltaTime > 0.25f) 
-            deltaTime = 0.25f;
-        if (deltaTime < 0.001f) 
-            deltaTime = 0.016f;
-
-        accumulatedTime += deltaTime;
-
-        while (accumulatedTime >= fixedTimeStep) {
-            updateCamera(fixedTimeStep);
-            accumulatedTime -= fixedTimeStep;
+        frame = &frames.read();
+        {
+            PROFILE_SCOPE("handleInput");
+            handleInput();
         }
-
-        if (animationClock.getElapsedTime().asSeconds() > 0.1f) {
-            animationClock.restart();
-            currentPlayerFrame = (currentPlayerFrame + 1) % 4;
-            currentCoinFrame = (currentCoinFrame + 1) % 6;
-            currentZapperFrame = (currentZapperFrame + 1) % 4;
+        {
+            PROFILE_SCOPE("fixedUpdate");
+            fixedUpdate(fixedTimeStep);
         }
-        render();
-        sf::Time frameTime = frameClock.getElapsedTime() - sf::seconds(previousTime);
-        sf::Time sleepTime = sf::seconds(1.0f/60.0f) - frameTime;
-        if (sleepTime > sf::Time::Zero) {
-            sf::sleep(sleepTime);
+        publishRenderFrame();
+
+        nextTick += tickDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (nextTick < now - tickDuration) {
+            nextTick = now;
         }
+        std::this_thread::sleep_until(nextTick);
     }
 
-    debugPrint("Thread graphique terminé");
+    LOG_DEBUG("Thread d'entrée terminé");
 }
 
-void Client::simulateLocalPlayer(float deltaTime) {
-    if (deltaTime <= 0.001f || std::isnan(deltaTime)) return;
-    
-    if (myPlayerId < 0 || myPlayerId >= MAX_PLAYERS || gameState != RUNNING) {
-        return;
-    }
-    
-    std::lock_guard<std::mutex> lock(gameMutex);
-    Player& me = players[myPlayerId];
-    
-    if (!me.alive) 
-        return;
+void Client::graphicsLoop() {
+    LOG_DEBUG("Thread graphique démarré");
 
-    sendPlayerPosition(jetpackActive);
-    
-    if (jetpackActive) {
-        float estimatedVelocity = -10.0f;
-        float estimatedNewY = me.position.y + estimatedVelocity * deltaTime;
-        
-        if (estimatedNewY < 0) {
-            estimatedNewY = 0;
+    Profiler& profiler = Profiler::instance();
+    profiler.setThreadName("graphics");
+    int64_t previousFrameStart = Profiler::now();
+    window.setActive(true);
+
+    const float fixedTimeStep = 1.0f / 60.0f;
+    auto frameDeadline = std::chrono::steady_clock::now();
+
+    while (running && window.isOpen()) {
+        int64_t frameStart = Profiler::now();
+        profiler.recordFrame(frameStart - previousFrameStart);
+        previousFrameStart = frameStart;
+
+        view = &renderFrames.read();
+        if (!assetLoader.isDone()) {
+            PROFILE_SCOPE("assets");
+            assetLoader.poll();
         }
-        me.velocityY = estimatedVelocity;
-        me.position.y = estimatedNewY;
-    } else {
-        float estimatedVelocity = 10.0f;
-        float estimatedNewY = me.position.y + estimatedVelocity * deltaTime;
-        const float CELL_SIZE = 32.0f;
-        float floorY = (gameMap.getHeight() - 2) * CELL_SIZE - PLAYER_HEIGHT;
-        if (estimatedNewY > floorY) {
-            estimatedVelocity = 0.0f;
+
+        float alpha = (frameStart - view->publishedNs) / (fixedTimeStep * 1e9f);
+        interpolate(alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha));
+        {
+            PROFILE_SCOPE("render");
+            render();
+            if (view->showOverlay) {
+                renderOverlay();
+            }
+        }
+        {
+            PROFILE_SCOPE("display");
+            window.display();
         }
-        me.velocityY = estimatedVelocity;
-        me.position.y = estimatedNewY;
+        if (profiler.isEnabled()) {
+            profiler.record("frame", frameStart, Profiler::now());
+        }
+        waitForNextFrame(frameDeadline);
     }
-}
 
+    window.setActive(false);
+    LOG_DEBUG("Thread graphique terminé");
+}
 
-void Client::updateCamera(float deltaTime) {
-    if (gameState == RUNNING && myPlayerId >= 0 && myPlayerId < MAX_PLAYERS) {
-        float playerX = players[myPlayerId].position.x;
-        float targetCameraX = playerX - windowWidth * 0.3f;
-        float cameraSpeed = 5.0f;
-        const float CELL_SIZE = 32.0f;
-        float maxCameraX = gameMap.getWidth() * CELL_SIZE - windowWidth;
-        cameraX += (targetCameraX - cameraX) * cameraSpeed * deltaTime;
+void Client::fixedUpdate(float deltaTime) {
+    previousCameraX = cameraX;
+    updateCamera(deltaTime);
 
-        if (cameraX < 0) {
-            cameraX = 0;
+    previousPositions = currentPositions;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        currentPositions[i] = frame->players[i].position;
+        // Do not slide across the map when a new match puts players back at the start.
+        if (currentPositions[i].x < previousPositions[i].x) {
+            previousPositions[i] = currentPositions[i];
         }
+    }
 
-        if (maxCameraX > 0 && cameraX > maxCameraX) {
-            cameraX = maxCameraX;
-        }
+    if (++animationTicks >= 6) {
+        animationTicks = 0;
+        currentPlayerFrame = (currentPlayerFrame + 1) % 4;
+        currentCoinFrame = (currentCoinFrame + 1) % 6;
+        currentZapperFrame = (currentZapperFrame + 1) % 4;
     }
 }
 
-void Client::sendPlayerPosition(bool jetpackOn) {
-    if (myPlayerId < 0 || myPlayerId >= MAX_PLAYERS) {
-        return;
-    }
+void Client::publishRenderFrame() {
+    RenderFrame& next = renderFrames.writeBuffer();
+    next.snapshot = *frame;
+    next.previousCameraX = previousCameraX;
+    next.cameraX = cameraX;
+    next.previousPositions = previousPositions;
+    next.currentPositions = currentPositions;
+    next.jetpackActive = jetpackActive;
+    next.showOverlay = showOverlay;
+    next.playerFrame = currentPlayerFrame;
+    next.coinFrame = currentCoinFrame;
+    next.zapperFrame = currentZapperFrame;
+    next.publishedNs = Profiler::now();
+    renderFrames.publish();
+}
 
-    if (clientSocket < 0 || gameState != RUNNING) {
-        return;
+void Client::interpolate(float alpha) {
+    renderCameraX = view->previousCameraX + (view->cameraX - view->previousCameraX) * alpha;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const Vector2& previous = view->previousPositions[i];
+        const Vector2& current = view->currentPositions[i];
+        renderPositions[i].x = previous.x + (current.x - previous.x) * alpha;
+        renderPositions[i].y = previous.y + (current.y - previous.y) * alpha;
     }
-    
-    int player_id = myPlayerId;
-    float x = players[myPlayerId].position.x;
-    float y = players[myPlayerId].position.y;
-    int jetpack_on = jetpackOn ? 1 : 0;
-    char buffer[16];
-    int offset = 0;
-    std::memcpy(buffer + offset, &player_id, sizeof(int));
-    offset += sizeof(int);
-    std::memcpy(buffer + offset, &x, sizeof(float));
-    offset += sizeof(float);
-    std::memcpy(buffer + offset, &y, sizeof(float));
-    offset += sizeof(float);
-    std::memcpy(buffer + offset, &jetpack_on, sizeof(int));
-    Protocol::sendPacket(clientSocket, PLAYER_POS, buffer, 16);
 }
 
-void Client::handleServerMessage() {
-    if (clientSocket < 0) {
-        std::cerr << "Socket invalide dans handleServerMessage" << std::endl;
+void Client::waitForNextFrame(std::chrono::steady_clock::time_point& deadline) {
+    // With vsync display() already blocks; uncapped never waits.
+    if (framePacing != PACING_LIMIT) {
         return;
     }
+    PROFILE_SCOPE("pace");
 
-    char buffer[MAX_BUFFER_SIZE];
-    int packetType;
-
-    struct pollfd pfd = {clientSocket, POLLIN, 0};
-    int ret = poll(&pfd, 1, 100);
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / targetFps));
+    const auto spinMargin = std::chrono::microseconds(1000);
+    auto now = std::chrono::steady_clock::now();
 
-    if (ret < 0) {
-        std::cerr << "Erreur de poll: " << strerror(errno) << std::endl;
+    deadline += period;
+    if (deadline < now - period) {
+        deadline = now;
         return;
     }
-
-    if (ret == 0) return;
-
-    int dataSize = Protocol::receivePacket(clientSocket, packetType, buffer, MAX_BUFFER_SIZE);
-    if (dataSize < 0) {
-        std::cerr << "Erreur de réception: " << strerror(errno) << std::endl;
-        running = false;
-        return;
+    if (deadline - now > spinMargin) {
+        std::this_thread::sleep_until(deadline - spinMargin);
     }
-
-    if (dataSize == 0) {
-        debugPrint("Connexion fermée par le serveur");
-        running = false;
-        return;
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
     }
+}
 
-    switch (packetType) {
-        case ASSIGN_PLAYER_ID: {
-            if (dataSize < (int)sizeof(int)) {
-                debugPrint("Paquet ASSIGN_PLAYER_ID invalide");
-                break;
+void Client::updateCamera(float deltaTime) {
+    const ClientSnapshot& state = *frame;
+
+    int followId = state.myPlayerId;
+    if (followId < 0) {
+        // Spectators follow the leading player still alive.
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (state.players[i].alive && (followId < 0 ||
+                state.players[i].position.x > state.players[followId].position.x)) {
+                followId = i;
             }
-
-            int assignedId;
-            std::memcpy(&assignedId, buffer, sizeof(int));
-
-            std::lock_guard<std::mutex> lock(gameMutex);
-            myPlayerId = assignedId;
-            debugPrint("[INIT] Mon playerId assigné par le serveur: " + std::to_string(myPlayerId));
-            break;
         }
+    }
 
-        case MAP_DATA: {
-            buffer[dataSize] = '\0';
-            std::lock_guard<std::mutex> lock(gameMutex);
-            std::string mapString(buffer, dataSize);
-            debugPrint("[MAP] Données reçues:\n" + mapString);
-
-            if (gameMap.fromString(mapString)) {
-                debugPrint("Carte chargée avec succès");
-            } else {
-                debugPrint("Erreur lors du chargement de la carte");
-            }
-            break;
-        }
+    if (state.gameState == RUNNING && followId >= 0 && followId < MAX_PLAYERS) {
+        float playerX = state.players[followId].position.x;
+        float targetCameraX = playerX - windowWidth * 0.3f;
+        float cameraSpeed = 5.0f;
+        const float CELL_SIZE = 32.0f;
+        float maxCameraX = state.map->getWidth() * CELL_SIZE - windowWidth;
+        cameraX += (targetCameraX - cameraX) * cameraSpeed * deltaTime;
 
-        case GAME_STATE: {
-            struct PlayerData {
-                int player_id;
-                float x, y;
-                int score;
-                int alive;
-                int jetpackOn;
-            } playerData[MAX_PLAYERS];
-        
-            int game_state;
-            std::memcpy(&game_state, buffer, sizeof(int));
-        
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                std::memcpy(&playerData[i], buffer + sizeof(int) + i * sizeof(PlayerData), sizeof(PlayerData));
-            }
-        
-            std::lock_guard<std::mutex> lock(gameMutex);
-            gameState = static_cast<GameState>(game_state);
-            
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                int id = playerData[i].player_id;
-                if (id >= 0 && id < MAX_PLAYERS) {
-                    players[id].id = id;
-                    players[id].position.x = playerData[i].x;
-                    players[id].position.y = playerData[i].y;
-                    players[id].score = playerData[i].score;
-                    players[id].alive = playerData[i].alive != 0;
-                    
-                    if (id != myPlayerId) {
-                        players[id].jetpackOn = playerData[i].jetpackOn != 0;
-                    }
-                    
-                    if (myPlayerId == -1) {
-                        myPlayerId = id;
-                        debugPrint("Mon ID de joueur: " + std::to_string(myPlayerId));
-                    }
-                }
-            }
-            break;
+        if (cameraX < 0) {
+            cameraX = 0;
         }
 
-        case GAME_OVER: {
-            if (dataSize < (int)sizeof(int) + (int)(sizeof(int) * MAX_PLAYERS)) {
-                debugPrint("Paquet GAME_OVER invalide");
-                break;
-            }
-
-            struct {
-                int winner_id;
-                int scores[MAX_PLAYERS];
-            } data;
-            std::memcpy(&data, buffer, sizeof(data));
-            std::lock_guard<std::mutex> lock(gameMutex);
-            gameState = OVER;
-
-            std::string message = "Fin de partie! ";
-            if (data.winner_id >= 0 && data.winner_id < MAX_PLAYERS) {
-                message += "Joueur " + std::to_string(data.winner_id + 1) + " a gagné avec " +
-                           std::to_string(data.scores[data.winner_id]) + " points!";
-            } else {
-                message += "Pas de gagnant.";
-            }
-            std::cout << message << std::endl;
-            break;
+        if (maxCameraX > 0 && cameraX > maxCameraX) {
+            cameraX = maxCameraX;
         }
+    }
+}
 
-        case WAITING_STATUS: {
-            if (dataSize < (int)sizeof(int)) {
-                debugPrint("Paquet WAITING_STATUS invalide");
-                break;
-            }
-
-            int connectedCount;
-            std::memcpy(&connectedCount, buffer, sizeof(int));
-            std::lock_guard<std::mutex> lock(gameMutex);
-            waitingPlayers = connectedCount;
-            gameState = WAITING;
-            break;
-        }
+void Client::sendPlayerPosition(bool jetpackOn) {
+    session.sendPlayerPosition(*frame, jetpackOn);
+}
 
-        default:
-            break;
-    }
+void Client::publishState() {
+    frames.writeBuffer() = session.state();
+    frames.publish();
 }
 
 void Client::renderPlayer(int x, int y, int, int, bool jetpackOn) {
@@ -449,11 +373,14 @@ void Client::renderPlayer(int x, int y, int, int, bool jetpackOn) {
     const int FRAME_HEIGHT = 135;
     const int SPRITES_PER_ROW = 4;
     int row = jetpackOn ? 1 : 0;
-    int col = currentPlayerFrame % SPRITES_PER_ROW;
+    int col = view->playerFrame % SPRITES_PER_ROW;
     int sourceX = col * FRAME_WIDTH;
     int sourceY = row * FRAME_HEIGHT;
 
-    sf::Sprite playerSprite = sprites["player_sprite_sheet"];
+    if (!textureReady[TEXTURE_PLAYER]) {
+        return;
+    }
+    sf::Sprite& playerSprite = sprites[TEXTURE_PLAYER];
     playerSprite.setTextureRect(sf::IntRect(sourceX, sourceY, FRAME_WIDTH, FRAME_HEIGHT));
     playerSprite.setOrigin(FRAME_WIDTH / 2.f, FRAME_HEIGHT);
     playerSprite.setScale(0.5f, 0.5f);
@@ -465,11 +392,14 @@ void Client::renderPlayer(int x, int y, int, int, bool jetpackOn) {
 void Client::renderCoin(int x, int y, int width, int height) {
     const int COIN_WIDTH = 180;
     const int COIN_HEIGHT = 180;
-    int col = currentCoinFrame % 6;
+    int col = view->coinFrame % 6;
     int sourceX = col * COIN_WIDTH;
     int sourceY = 0;
     
-    sf::Sprite coinSprite = sprites["coins_sprite_sheet"];
+    if (!textureReady[TEXTURE_COINS]) {
+        return;
+    }
+    sf::Sprite& coinSprite = sprites[TEXTURE_COINS];
     coinSprite.setTextureRect(sf::IntRect(sourceX, sourceY, COIN_WIDTH, COIN_HEIGHT));
     coinSprite.setPosition(x, y);
     coinSprite.setScale(
@@ -485,12 +415,15 @@ void Client::renderZapper(int x, int y, int displayWidth, int displayHeight)
     const int SPRITE_WIDTH = 100;
     const int SPRITE_HEIGHT = 128;
     const int NUM_FRAMES = 5;
-    int col = currentZapperFrame % NUM_FRAMES;
+    int col = view->zapperFrame % NUM_FRAMES;
     int sourceX = col * SPRITE_WIDTH;
     int sourceY = 0;
 
-    debugPrint("Découpe du zapper : (" + std::to_string(sourceX) + ", " + std::to_string(sourceY) + ")");
-    sf::Sprite zapperSprite = sprites["zapper_sprite_sheet"];
+    LOG_TRACE("Découpe du zapper : (" << sourceX << ", " << sourceY << ")");
+    if (!textureReady[TEXTURE_ZAPPER]) {
+        return;
+    }
+    sf::Sprite& zapperSprite = sprites[TEXTURE_ZAPPER];
     zapperSprite.setTextureRect(sf::IntRect(sourceX, sourceY, SPRITE_WIDTH, SPRITE_HEIGHT));
     float finalHeight = static_cast<float>(displayHeight - 30);
     float scaleX = static_cast<float>(displayWidth) / SPRITE_WIDTH;
@@ -501,35 +434,39 @@ void Client::renderZapper(int x, int y, int displayWidth, int displayHeight)
 }
 
 void Client::render() {
+    const ClientSnapshot& state = view->snapshot;
+    const Map& gameMap = *state.map;
+
     window.clear(sf::Color::Black);
 
-    if (gameState == WAITING) {
+    if (state.gameState == WAITING) {
         sf::Text waitingText;
         waitingText.setFont(font);
-        waitingText.setString("En attente de joueurs (" + std::to_string(waitingPlayers) + "/2)");
+        waitingText.setString("En attente d'une partie (" + std::to_string(state.waitingPlayers) + " en file)");
         waitingText.setCharacterSize(24);
         waitingText.setFillColor(sf::Color::White);
         waitingText.setPosition(windowWidth / 2 - waitingText.getGlobalBounds().width / 2, windowHeight / 2 - 12);
         window.draw(waitingText);
-        window.display();
         return;
     }
 
     const float CELL_SIZE = 32.0f;
     const float MAP_OFFSET_Y = 0.0f;
     
-    sf::View gameView(sf::FloatRect(cameraX, 0, windowWidth, windowHeight));
+    sf::View gameView(sf::FloatRect(renderCameraX, 0, windowWidth, windowHeight));
     window.setView(gameView);
 
-    sprites["background"].setPosition(cameraX, 0);
-    sprites["background"].setScale(
-        float(windowWidth) / textures["background"].getSize().x,
-        float(windowHeight) / textures["background"].getSize().y
-    );
-    window.draw(sprites["background"]);
+    if (textureReady[TEXTURE_BACKGROUND]) {
+        sprites[TEXTURE_BACKGROUND].setPosition(renderCameraX, 0);
+        sprites[TEXTURE_BACKGROUND].setScale(
+            float(windowWidth) / textures[TEXTURE_BACKGROUND].getSize().x,
+            float(windowHeight) / textures[TEXTURE_BACKGROUND].getSize().y
+        );
+        window.draw(sprites[TEXTURE_BACKGROUND]);
+    }
 
-    int visibleStartX = static_cast<int>(cameraX / CELL_SIZE);
-    int visibleEndX = static_cast<int>((cameraX + windowWidth) / CELL_SIZE) + 1;
+    int visibleStartX = static_cast<int>(renderCameraX / CELL_SIZE);
+    int visibleEndX = static_cast<int>((renderCameraX + windowWidth) / CELL_SIZE) + 1;
 
     for (int y = 0; y < gameMap.getHeight(); y++) {
         for (int x = visibleStartX; x < visibleEndX && x < gameMap.getWidth(); x++) {
@@ -547,14 +484,12 @@ void Client::render() {
     }
     
     for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (players[i].alive) {
-            float screenX = players[i].position.x;
-            float screenY = players[i].position.y + MAP_OFFSET_Y;
-            bool isJetpackActive = (i == myPlayerId) ? jetpackActive : players[i].jetpackOn;
+        if (state.players[i].alive) {
+            float screenX = renderPositions[i].x;
+            float screenY = renderPositions[i].y + MAP_OFFSET_Y;
+            bool isJetpackActive = (i == state.myPlayerId) ? view->jetpackActive : state.players[i].jetpackOn;
             renderPlayer(screenX, screenY, 0, 0, isJetpackActive);
-            debugPrint("Rendu du joueur " + std::to_string(i) + " à la position (" +
-                       std::to_string(screenX) + "," + std::to_string(screenY) + ") jetpack: " +
-                       std::to_string(isJetpackActive));
+            LOG_TRACE("Rendu du joueur " << i << " à la position (" << screenX << "," << screenY << ") jetpack: " << isJetpackActive);
         }
     }
 
@@ -563,14 +498,14 @@ void Client::render() {
     for (int i = 0; i < MAX_PLAYERS; i++) {
         sf::Text scoreText;
         scoreText.setFont(font);
-        scoreText.setString("PLAYER " + std::to_string(i + 1) + " " + std::to_string(players[i].score));
+        scoreText.setString("PLAYER " + std::to_string(i + 1) + " " + std::to_string(state.players[i].score));
         scoreText.setCharacterSize(18);
         scoreText.setFillColor(sf::Color::White);
         scoreText.setPosition(10, 10 + i * 30);
         window.draw(scoreText);
     }
 
-    if (gameState == OVER) {
+    if (state.gameState == OVER) {
         sf::Text endText;
         endText.setFont(font);
         endText.setString("Fin de partie!");
@@ -579,75 +514,112 @@ void Client::render() {
         endText.setPosition(windowWidth / 2 - endText.getGlobalBounds().width / 2, windowHeight / 2 - 18);
         window.draw(endText);
     }
+}
+
+void Client::renderOverlay() {
+    if (overlayClock.getElapsedTime().asSeconds() > 0.5f) {
+        overlayClock.restart();
+        overlayStats = Profiler::instance().frameStats();
+    }
 
-    window.display();
+    char line[256];
+    int length = std::snprintf(line, sizeof(line), "frame p50 %.1fms  p95 %.1fms  p99 %.1fms  max %.1fms\n",
+        overlayStats.p50Ms, overlayStats.p95Ms, overlayStats.p99Ms, overlayStats.maxMs);
+    const ClientSnapshot& net = view->snapshot;
+    int snapshotHz = 60 / std::max(1, net.snapshotInterval);
+    if (net.rttUs >= 0) {
+        std::snprintf(line + length, sizeof(line) - length, "rtt %.1fms  jitter %.1fms  snapshots %dHz",
+            net.rttUs / 1000.0, net.jitterUs / 1000.0, snapshotHz);
+    } else {
+        std::snprintf(line + length, sizeof(line) - length, "rtt --  snapshots %dHz", snapshotHz);
+    }
+
+    sf::RectangleShape background(sf::Vector2f(windowWidth, 42));
+    background.setFillColor(sf::Color(0, 0, 0, 160));
+    background.setPosition(0, windowHeight - 42);
+    window.draw(background);
+
+    sf::Text statsText;
+    statsText.setFont(font);
+    statsText.setString(line);
+    statsText.setCharacterSize(14);
+    statsText.setFillColor(sf::Color::Yellow);
+    statsText.setPosition(6, windowHeight - 39);
+    window.draw(statsText);
 }
 
 void Client::handleInput() {
+    const ClientSnapshot& state = *frame;
     sf::Event event;
     while (running && window.isOpen() && window.pollEvent(event)) {
         if (event.type == sf::Event::Closed) {
-            window.close();
             running = false;
             return;
         }
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+            showOverlay = !showOverlay;
+            Profiler::instance().setEnabled(showOverlay || !traceFile.empty());
+        }
         else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space) {
-            if (!jetpackActive && gameState == RUNNING) {
+            if (!jetpackActive && state.gameState == RUNNING) {
                 jetpackActive = true;
-                sf::Sound startSound;
-                startSound.setBuffer(soundBuffers["jetpack_start"]);
-                startSound.play();
-                jetpackSound.play();
+                setJetpackSound(true);
                 sendPlayerPosition(true);
-                debugPrint("Jetpack activé par l'utilisateur");
+                LOG_DEBUG("Jetpack activé par l'utilisateur");
             }
         }
         else if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::Space) {
-            if (jetpackActive && gameState == RUNNING) {
+            if (jetpackActive && state.gameState == RUNNING) {
                 jetpackActive = false;
-                jetpackSound.stop();
-                sf::Sound stopSound;
-                stopSound.setBuffer(soundBuffers["jetpack_stop"]);
-                stopSound.play();
+                setJetpackSound(false);
                 sendPlayerPosition(false);
-                debugPrint("Jetpack désactivé par l'utilisateur");
+                LOG_DEBUG("Jetpack désactivé par l'utilisateur");
             }
         }
     }
     
-    if (running && window.isOpen() && gameState == RUNNING && myPlayerId >= 0 && players[myPlayerId].alive) {
+    if (running && window.isOpen() && state.gameState == RUNNING && state.myPlayerId >= 0 &&
+        state.myPlayerId < MAX_PLAYERS && state.players[state.myPlayerId].alive) {
         bool spacePressed = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
         
         if (spacePressed != jetpackActive) {
             jetpackActive = spacePressed;
             
-            if (jetpackActive) {
-                if (jetpackSound.getStatus() != sf::Sound::Playing) {
-                    sf::Sound startSound;
-                    startSound.setBuffer(soundBuffers["jetpack_start"]);
-                    startSound.play();
-                    jetpackSound.play();
-                }
-            } else {
-                if (jetpackSound.getStatus() == sf::Sound::Playing) {
-                    jetpackSound.stop();
-                    sf::Sound stopSound;
-                    stopSound.setBuffer(soundBuffers["jetpack_stop"]);
-                    stopSound.play();
-                }
-            }
+            setJetpackSound(jetpackActive);
             sendPlayerPosition(jetpackActive);
-            debugPrint("État du jetpack mis à jour: " + std::to_string(jetpackActive));
+            LOG_DEBUG("État du jetpack mis à jour: " << jetpackActive);
         }
     }
 }
 
+void Client::setJetpackSound(bool on) {
+    bool playing = jetpackSound.getStatus() == sf::Sound::Playing;
+    if (on && !playing) {
+        sounds.play(SOUND_JETPACK_START, 1);
+        if (sounds.isReady(SOUND_JETPACK_LOOP)) {
+            jetpackSound.play();
+        }
+    } else if (!on && playing) {
+        jetpackSound.stop();
+        sounds.play(SOUND_JETPACK_STOP, 1);
+    }
+}
+
 void Client::networkLoop() {
-    debugPrint("Thread réseau démarré");
+    LOG_DEBUG("Thread réseau démarré");
+    Profiler::instance().setThreadName("network");
     
     while (running) {
         try {
-            handleServerMessage();
+            int handled = session.poll(100);
+            if (handled < 0) {
+                running = false;
+                break;
+            }
+            if (handled > 0) {
+                PROFILE_SCOPE("publishState");
+                publishState();
+            }
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
         } catch (const std::exception& e) {
             std::cerr << "Exception dans networkLoop: " << e.what() << std::endl;
@@ -655,5 +627,5 @@ void Client::networkLoop() {
     }
     
     running = false;
-    debugPrint("Thread réseau terminé");
+    LOG_DEBUG("Thread réseau terminé");
 }
\ No newline at end of file
@@ -4,15 +4,24 @@
 #include <string>
 
 void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " -h <ip> -p <port> [-d]" << std::endl;
+    std::cout << "Usage: " << programName << " -h <ip> -p <port> [-s] [-f <mode>] [-r <fps>] [-t <file>] [-d]" << std::endl;
     std::cout << "  -h <ip>    IP address of the server" << std::endl;
     std::cout << "  -p <port>  Port of the server" << std::endl;
+    std::cout << "  -s         Watch the match as a spectator" << std::endl;
+    std::cout << "  -f <mode>  Frame pacing: vsync, limit (default) or uncapped" << std::endl;
+    std::cout << "  -r <fps>   Frame rate of the limit mode (default 60)" << std::endl;
+    std::cout << "  -t <file>  Write a Chrome trace (chrome://tracing) on exit" << std::endl;
     std::cout << "  -d         Enable debug mode" << std::endl;
+    std::cout << "Press F3 in game to show frame time percentiles." << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     std::string serverIP = "127.0.0.1";
     int port = 0;
+    std::string traceFile;
+    FramePacing pacing = PACING_LIMIT;
+    int fps = 60;
+    bool spectator = false;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -21,6 +30,25 @@ int main(int argc, char* argv[]) {
             serverIP = argv[++i];
         } else if (arg == "-p" && i + 1 < argc) {
             port = std::atoi(argv[++i]);
+        } else if (arg == "-s") {
+            spectator = true;
+        } else if (arg == "-f" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "vsync") {
+                pacing = PACING_VSYNC;
+            } else if (mode == "limit") {
+                pacing = PACING_LIMIT;
+            } else if (mode == "uncapped") {
+                pacing = PACING_UNCAPPED;
+            } else {
+                std::cerr << "Unknown frame pacing mode: " << mode << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "-r" && i + 1 < argc) {
+            fps = std::atoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            traceFile = argv[++i];
         } else if (arg == "-d") {
             debug_mode = true;
         } else {
@@ -30,13 +58,16 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    if (port <= 0) {
+    if (port <= 0 || fps <= 0) {
         std::cerr << "Missing required arguments!" << std::endl;
         printUsage(argv[0]);
         return 1;
     }
     
     Client client(serverIP, port);
+    client.setTraceFile(traceFile);
+    client.setFramePacing(pacing, fps);
+    client.setSpectator(spectator);
     
     if (!client.connect()) {
         std::cerr << "Failed to connect to server" << std::endl;
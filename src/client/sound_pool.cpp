@@ -0,0 +1,56 @@
+#include "sound_pool.hpp"
+
+bool SoundPool::load(SoundId id, const std::string& filename) {
+    bool loaded = buffers[id].loadFromFile(filename);
+    ready[id].store(loaded, std::memory_order_release);
+    return loaded;
+}
+
+bool SoundPool::loadFromMemory(SoundId id, const void* data, size_t size) {
+    return buffers[id].loadFromMemory(data, size);
+}
+
+int SoundPool::play(SoundId id, int priority) {
+    if (!isReady(id)) {
+        return -1;
+    }
+    int voice = findVoice(priority);
+    if (voice < 0) {
+        return -1;
+    }
+
+    voices[voice].stop();
+    voices[voice].setBuffer(buffers[id]);
+    voices[voice].play();
+    priorities[voice] = priority;
+    startOrder[voice] = ++playCount;
+    return voice;
+}
+
+void SoundPool::stopAll() {
+    for (sf::Sound& voice : voices) {
+        voice.stop();
+    }
+}
+
+int SoundPool::findVoice(int priority) {
+    for (int i = 0; i < VOICE_COUNT; i++) {
+        int voice = (nextVoice + i) % VOICE_COUNT;
+        if (voices[voice].getStatus() == sf::Sound::Stopped) {
+            nextVoice = (voice + 1) % VOICE_COUNT;
+            return voice;
+        }
+    }
+
+    int victim = -1;
+    for (int voice = 0; voice < VOICE_COUNT; voice++) {
+        if (priorities[voice] > priority) {
+            continue;
+        }
+        if (victim < 0 || priorities[voice] < priorities[victim] ||
+            (priorities[voice] == priorities[victim] && startOrder[voice] < startOrder[victim])) {
+            victim = voice;
+        }
+    }
+    return victim;
+}
@@ -0,0 +1,125 @@
+#include "asset_pack.hpp"
+#include "bytes.hpp"
+#include <fcntl.h>
+#include <iterator>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+AssetPack::~AssetPack() {
+    if (mapping) {
+        munmap(const_cast<uint8_t*>(mapping), mappingSize);
+    }
+}
+
+bool AssetPack::open(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Impossible d'ouvrir le pack d'assets " << filename << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size <= 0) {
+        std::cerr << "Pack d'assets vide: " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+
+    void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        std::cerr << "mmap du pack d'assets impossible: " << strerror(errno) << std::endl;
+        return false;
+    }
+    mapping = static_cast<const uint8_t*>(address);
+    mappingSize = info.st_size;
+    madvise(address, mappingSize, MADV_WILLNEED);
+
+    ByteReader reader(mapping, mappingSize);
+    const uint8_t* magic = reader.bytes(4);
+    uint32_t version = reader.u32();
+    uint32_t count = reader.u32();
+    if (!magic || std::memcmp(magic, "JPAK", 4) != 0 || version != VERSION) {
+        std::cerr << "Pack d'assets invalide: " << filename << std::endl;
+        return false;
+    }
+
+    entries.clear();
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        uint32_t nameLength = reader.u32();
+        const uint8_t* name = reader.bytes(nameLength);
+        uint64_t offset = reader.u64();
+        uint64_t size = reader.u64();
+        if (!reader.ok() || offset > mappingSize || size > mappingSize - offset) {
+            std::cerr << "Entrée corrompue dans le pack d'assets: " << filename << std::endl;
+            return false;
+        }
+        AssetEntry entry;
+        entry.name.assign(reinterpret_cast<const char*>(name), nameLength);
+        entry.data = mapping + offset;
+        entry.size = size;
+        entries.push_back(entry);
+    }
+    LOG_DEBUG("Pack d'assets " << filename << ": " << entries.size() << " fichiers, " << mappingSize << " octets");
+    return reader.ok();
+}
+
+const AssetEntry* AssetPack::find(const std::string& name) const {
+    for (const AssetEntry& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool AssetPack::write(const std::string& filename, const std::vector<std::string>& files) {
+    std::vector<std::vector<char>> contents;
+    std::vector<std::string> names;
+    for (const std::string& path : files) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Impossible de lire " << path << std::endl;
+            return false;
+        }
+        contents.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        size_t slash = path.find_last_of('/');
+        names.push_back(slash == std::string::npos ? path : path.substr(slash + 1));
+    }
+
+    size_t headerSize = 12;
+    for (const std::string& name : names) {
+        headerSize += 4 + name.size() + 16;
+    }
+
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.bytes("JPAK", 4);
+    writer.u32(VERSION);
+    writer.u32(files.size());
+    uint64_t offset = headerSize;
+    std::vector<uint64_t> offsets;
+    for (size_t i = 0; i < files.size(); i++) {
+        offset = (offset + 15) & ~uint64_t(15);
+        offsets.push_back(offset);
+        writer.u32(names[i].size());
+        writer.bytes(names[i].data(), names[i].size());
+        writer.u64(offset);
+        writer.u64(contents[i].size());
+        offset += contents[i].size();
+    }
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Impossible d'écrire " << filename << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    uint64_t position = header.size();
+    for (size_t i = 0; i < files.size(); i++) {
+        static const char padding[16] = {};
+        out.write(padding, offsets[i] - position);
+        out.write(contents[i].data(), contents[i].size());
+        position = offsets[i] + contents[i].size();
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,372 @@
+#include "async.hpp"
+#include <fcntl.h>
+#include <sys/epoll.h>
+
+#define EVENT_LOOP_MAX_EVENTS 256
+
+EventLoop::~EventLoop() {
+    tasks.clear();
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool EventLoop::open() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        std::cerr << "Erreur epoll_create1: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::spawn(Task<> task) {
+    Task<> root = supervise(std::move(task));
+    ready.push_back(root.handle());
+    tasks.push_back(std::move(root));
+}
+
+Task<> EventLoop::supervise(Task<> task) {
+    co_await task;
+    finishedTasks++;
+}
+
+bool EventLoop::add(int fd) {
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        std::cerr << "Erreur epoll_ctl: " << strerror(errno) << std::endl;
+        return false;
+    }
+    waiters[fd] = Waiters();
+    return true;
+}
+
+void EventLoop::remove(int fd) {
+    auto it = waiters.find(fd);
+    if (it == waiters.end()) {
+        return;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    if (it->second.reader) {
+        ready.push_back(it->second.reader);
+    }
+    if (it->second.writer) {
+        ready.push_back(it->second.writer);
+    }
+    waiters.erase(it);
+}
+
+void EventLoop::park(int fd, bool write, std::coroutine_handle<> handle) {
+    auto it = waiters.find(fd);
+    if (it == waiters.end()) {
+        // Not watched (or already removed): let the caller retry and fail.
+        ready.push_back(handle);
+        return;
+    }
+    (write ? it->second.writer : it->second.reader) = handle;
+}
+
+void EventLoop::schedule(Clock::time_point deadline, std::coroutine_handle<> handle) {
+    timers.push({deadline, nextSequence++, handle});
+}
+
+void EventLoop::resumeReady() {
+    while (!ready.empty()) {
+        resuming.swap(ready);
+        for (std::coroutine_handle<> handle : resuming) {
+            handle.resume();
+        }
+        resuming.clear();
+    }
+}
+
+void EventLoop::expireTimers(Clock::time_point now) {
+    while (!timers.empty() && timers.top().deadline <= now) {
+        ready.push_back(timers.top().handle);
+        timers.pop();
+    }
+}
+
+// Top-level tasks have nobody to resume when they finish, so they are
+// collected here instead, after the turn that finished them.
+void EventLoop::reapTasks() {
+    if (finishedTasks == 0) {
+        return;
+    }
+    finishedTasks = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].done()) {
+            continue;
+        }
+        if (kept != i) {
+            tasks[kept] = std::move(tasks[i]);
+        }
+        kept++;
+    }
+    tasks.erase(tasks.begin() + kept, tasks.end());
+}
+
+bool EventLoop::runUntil(Clock::time_point deadline) {
+    stopped = false;
+
+    while (!stopped) {
+        resumeReady();
+        reapTasks();
+
+        Clock::time_point now = Clock::now();
+        expireTimers(now);
+        if (!ready.empty()) {
+            continue;
+        }
+        if (now >= deadline) {
+            break;
+        }
+
+        Clock::time_point wake = deadline;
+        if (!timers.empty() && timers.top().deadline < wake) {
+            wake = timers.top().deadline;
+        }
+        // Rounded up: waking a little late beats spinning until the deadline.
+        int timeoutMs = std::chrono::ceil<std::chrono::milliseconds>(wake - now).count();
+        if (pollEvents(timeoutMs) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Goes back to epoll until it has nothing more, so a caller polling
+// descriptor() is only woken again by new readiness.
+bool EventLoop::runReady() {
+    while (true) {
+        resumeReady();
+        reapTasks();
+        expireTimers(Clock::now());
+        if (!ready.empty()) {
+            continue;
+        }
+        int count = pollEvents(0);
+        if (count < 0) {
+            return false;
+        }
+        if (count == 0) {
+            return true;
+        }
+    }
+}
+
+// Queues whoever was parked on a descriptor that became ready. Returns how
+// many events epoll reported, 0 on EINTR, or -1 if it failed.
+int EventLoop::pollEvents(int timeoutMs) {
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    int count = epoll_wait(epollFd, events, EVENT_LOOP_MAX_EVENTS, timeoutMs);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        std::cerr << "Erreur epoll_wait: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        auto it = waiters.find(events[i].data.fd);
+        if (it == waiters.end()) {
+            continue;
+        }
+        uint32_t flags = events[i].events;
+        if ((flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && it->second.reader) {
+            ready.push_back(std::exchange(it->second.reader, nullptr));
+        }
+        if ((flags & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && it->second.writer) {
+            ready.push_back(std::exchange(it->second.writer, nullptr));
+        }
+    }
+    return count;
+}
+
+AsyncSession::AsyncSession(EventLoop& loop)
+    : loop(loop), input(2 * (Wire::HeaderLayout::SIZE + MAX_BUFFER_SIZE)) {
+}
+
+AsyncSession::~AsyncSession() {
+    close();
+}
+
+bool AsyncSession::adopt(int socket) {
+    close();
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+    if (!loop.add(socket)) {
+        ::close(socket);
+        return false;
+    }
+    fd = socket;
+    return true;
+}
+
+int AsyncSession::release(std::vector<char>& unread) {
+    int socket = fd;
+    if (socket >= 0) {
+        loop.remove(socket);
+        fd = -1;
+    }
+    unread.assign(input.begin() + inputStart + consumed, input.begin() + inputEnd);
+    inputStart = 0;
+    inputEnd = 0;
+    consumed = 0;
+    output.clear();
+    outputSent = 0;
+    return socket;
+}
+
+Task<bool> AsyncSession::connect(const struct sockaddr* address, socklen_t length) {
+    close();
+    int socket = ::socket(address->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket < 0) {
+        std::cerr << "Erreur lors de la création du socket: " << strerror(errno) << std::endl;
+        co_return false;
+    }
+
+    bool pending = false;
+    if (::connect(socket, address, length) < 0) {
+        if (errno != EINPROGRESS) {
+            ::close(socket);
+            co_return false;
+        }
+        pending = true;
+    }
+    if (!adopt(socket)) {
+        co_return false;
+    }
+    if (pending) {
+        co_await loop.writable(fd);
+        int error = 0;
+        socklen_t errorLength = sizeof(error);
+        if (fd < 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLength) < 0 || error != 0) {
+            close();
+            co_return false;
+        }
+    }
+    co_return true;
+}
+
+bool AsyncSession::extractFrame(Frame& frame, bool& malformed) {
+    size_t available = inputEnd - inputStart;
+    if (available < Wire::HeaderLayout::SIZE) {
+        return false;
+    }
+
+    PacketHeader header;
+    if (!Protocol::readHeader(input.data() + inputStart, header) ||
+        header.length < 0 || header.length > MAX_BUFFER_SIZE) {
+        malformed = true;
+        return false;
+    }
+    size_t frameSize = Wire::HeaderLayout::SIZE + header.length;
+    if (available < frameSize) {
+        return false;
+    }
+
+    frame.type = header.type;
+    frame.data = input.data() + inputStart + Wire::HeaderLayout::SIZE;
+    frame.length = header.length;
+    consumed = frameSize;
+    return true;
+}
+
+Task<bool> AsyncSession::readFrame(Frame& frame) {
+    inputStart += consumed;
+    consumed = 0;
+
+    while (fd >= 0) {
+        bool malformed = false;
+        if (extractFrame(frame, malformed)) {
+            co_return true;
+        }
+        if (malformed) {
+            LOG_WARN("Paquet invalide, fermeture de la session sur le socket " << fd);
+            close();
+            break;
+        }
+
+        // Only the unfinished frame is moved, and only once the tail of the
+        // buffer can no longer hold a whole one.
+        if (inputStart == inputEnd) {
+            inputStart = 0;
+            inputEnd = 0;
+        } else if (input.size() - inputEnd < Wire::HeaderLayout::SIZE + MAX_BUFFER_SIZE) {
+            std::memmove(input.data(), input.data() + inputStart, inputEnd - inputStart);
+            inputEnd -= inputStart;
+            inputStart = 0;
+        }
+        ssize_t received = recv(fd, input.data() + inputEnd, input.size() - inputEnd, 0);
+        if (received > 0) {
+            inputEnd += received;
+        } else if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            co_await loop.readable(fd);
+        } else if (received < 0 && errno == EINTR) {
+            continue;
+        } else {
+            close();
+        }
+    }
+    co_return false;
+}
+
+Task<bool> AsyncSession::write(int packetType, const void* data, int length) {
+    size_t offset = output.size();
+    output.resize(offset + Wire::HeaderLayout::SIZE + length);
+    Protocol::writeHeader(output.data() + offset, packetType, length);
+    if (data && length > 0) {
+        std::memcpy(output.data() + offset + Wire::HeaderLayout::SIZE, data, length);
+    }
+    return flush();
+}
+
+Task<bool> AsyncSession::write(const SharedPacket& packet) {
+    output.insert(output.end(), packet->begin(), packet->end());
+    return flush();
+}
+
+Task<bool> AsyncSession::flush() {
+    if (flushing) {
+        co_await FlushAwaiter{*this};
+        co_return fd >= 0;
+    }
+
+    flushing = true;
+    while (fd >= 0 && outputSent < output.size()) {
+        ssize_t sent = send(fd, output.data() + outputSent, output.size() - outputSent, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            outputSent += sent;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            co_await loop.writable(fd);
+        } else if (errno != EINTR) {
+            close();
+        }
+    }
+    output.clear();
+    outputSent = 0;
+    flushing = false;
+    for (std::coroutine_handle<> waiter : flushWaiters) {
+        loop.post(waiter);
+    }
+    flushWaiters.clear();
+    co_return fd >= 0;
+}
+
+void AsyncSession::close() {
+    if (fd < 0) {
+        return;
+    }
+    loop.remove(fd);
+    ::close(fd);
+    fd = -1;
+    inputStart = 0;
+    inputEnd = 0;
+    consumed = 0;
+    output.clear();
+    outputSent = 0;
+}
@@ -0,0 +1,248 @@
+#include "fanout.hpp"
+#include <algorithm>
+#include <fcntl.h>
+
+FanOut::FanOut(size_t maxSpectators, size_t maxBacklog, SpectatorStats& stats)
+    : maxSpectators(maxSpectators), maxBacklog(maxBacklog), stats(stats), slots(maxSpectators) {
+    // publish() and flush() may run on a room worker, which must not allocate.
+    active.reserve(maxSpectators);
+    sending.reserve(maxSpectators);
+    retired.reserve(maxSpectators);
+    freeSlots.reserve(maxSpectators);
+    for (size_t slot = maxSpectators; slot > 0; slot--) {
+        freeSlots.push_back(slot - 1);
+    }
+}
+
+FanOut::~FanOut() {
+    closeAll();
+}
+
+bool FanOut::add(int socket, const std::vector<SharedPacket>& catchUp) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeSlots.empty()) {
+        close(socket);
+        return false;
+    }
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+
+    // Nobody sends from a free slot, so it is filled under the lock alone.
+    // Room for one more than the limit: publish() queues before it checks.
+    size_t slot = freeSlots.back();
+    Spectator& spectator = slots[slot];
+    spectator.backlog = PacketBacklog(std::max(maxBacklog, catchUp.size()) + 1);
+    for (const SharedPacket& packet : catchUp) {
+        if (packet) {
+            spectator.backlog.push(packet);
+        }
+    }
+    if (!spectator.backlog.flush(socket, &stats.traffic)) {
+        spectator.backlog.clear();
+        close(socket);
+        return false;
+    }
+    spectator.socket = socket;
+    freeSlots.pop_back();
+    active.push_back(slot);
+    stats.connected.store(active.size(), std::memory_order_relaxed);
+    LOG_DEBUG("Spectateur ajouté, socket: " << socket << ", total: " << active.size());
+    return true;
+}
+
+void FanOut::publish(const SharedPacket& packet) {
+    std::lock_guard<std::mutex> publishing(publishMutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t kept = 0;
+    for (size_t slot : active) {
+        Spectator& spectator = slots[slot];
+        spectator.backlog.push(packet);
+        if (spectator.backlog.size() > maxBacklog) {
+            LOG_DEBUG("Spectateur trop lent, socket: " << spectator.socket);
+            retired.push_back(spectator.socket);
+            stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            vacate(slot);
+            continue;
+        }
+        active[kept++] = slot;
+    }
+    active.resize(kept);
+    stats.connected.store(active.size(), std::memory_order_relaxed);
+}
+
+// Spectators that join or leave meanwhile are not in this flush: the
+// first already got everything it is owed from add(), the second is only
+// marked and retired once the sends are over.
+void FanOut::flush() {
+    std::lock_guard<std::mutex> publishing(publishMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sending.clear();
+        for (size_t slot : active) {
+            if (!slots[slot].backlog.empty() && !slots[slot].closing) {
+                sending.push_back(&slots[slot]);
+            }
+        }
+        flushing = true;
+    }
+
+    for (Spectator* spectator : sending) {
+        if (!spectator->backlog.flush(spectator->socket, &stats.traffic)) {
+            LOG_DEBUG("Spectateur déconnecté pendant l'envoi, socket: " << spectator->socket);
+            spectator->failed = true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    flushing = false;
+    retireMarked();
+    stats.connected.store(active.size(), std::memory_order_relaxed);
+}
+
+// Under the lock, with no flush sending.
+void FanOut::retireMarked() {
+    size_t kept = 0;
+    for (size_t slot : active) {
+        Spectator& spectator = slots[slot];
+        if (spectator.closing || spectator.failed) {
+            if (spectator.failed) {
+                stats.dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            retired.push_back(spectator.socket);
+            vacate(slot);
+            continue;
+        }
+        active[kept++] = slot;
+    }
+    active.resize(kept);
+}
+
+void FanOut::vacate(size_t slot) {
+    Spectator& spectator = slots[slot];
+    spectator.socket = -1;
+    spectator.backlog.clear();
+    spectator.closing = false;
+    spectator.failed = false;
+    freeSlots.push_back(slot);
+}
+
+bool FanOut::remove(int socket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < active.size(); i++) {
+        Spectator& spectator = slots[active[i]];
+        if (spectator.socket != socket) {
+            continue;
+        }
+        if (flushing) {
+            spectator.closing = true;
+            return true;
+        }
+        close(socket);
+        vacate(active[i]);
+        active.erase(active.begin() + i);
+        stats.connected.store(active.size(), std::memory_order_relaxed);
+        LOG_DEBUG("Spectateur déconnecté, socket: " << socket);
+        return true;
+    }
+    return false;
+}
+
+void FanOut::appendPollFds(std::vector<pollfd>& fds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t slot : active) {
+        if (!slots[slot].closing) {
+            fds.push_back({slots[slot].socket, POLLIN, 0});
+        }
+    }
+}
+
+// Closes spectators whose peer hung up, for owners that do not poll them
+// themselves. Spectators have nothing to say once they joined: whatever
+// they send is read and discarded.
+void FanOut::dropClosed() {
+    closeRetired();
+    std::lock_guard<std::mutex> lock(mutex);
+    pollFds.clear();
+    for (size_t slot : active) {
+        pollFds.push_back({slots[slot].socket, POLLIN, 0});
+    }
+    if (pollFds.empty() || poll(pollFds.data(), pollFds.size(), 0) <= 0) {
+        return;
+    }
+
+    char discarded[MAX_BUFFER_SIZE];
+    size_t kept = 0;
+    for (size_t i = 0; i < active.size(); i++) {
+        Spectator& spectator = slots[active[i]];
+        if (!spectator.closing && (pollFds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+            ssize_t received = recv(spectator.socket, discarded, sizeof(discarded), MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                LOG_DEBUG("Spectateur déconnecté, socket: " << spectator.socket);
+                if (flushing) {
+                    spectator.closing = true;
+                } else {
+                    close(spectator.socket);
+                    vacate(active[i]);
+                    continue;
+                }
+            }
+        }
+        active[kept++] = active[i];
+    }
+    active.resize(kept);
+    stats.connected.store(active.size(), std::memory_order_relaxed);
+}
+
+void FanOut::closeRetired() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int socket : retired) {
+        close(socket);
+    }
+    retired.clear();
+}
+
+void FanOut::closeAll() {
+    std::lock_guard<std::mutex> publishing(publishMutex);
+    closeRetired();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t slot : active) {
+        close(slots[slot].socket);
+        vacate(slot);
+    }
+    active.clear();
+    stats.connected.store(0, std::memory_order_relaxed);
+}
+
+size_t FanOut::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return active.size();
+}
+
+void SpectatorFeed::publish(int packetType, const SharedPacket& packet) {
+    std::unique_lock<std::mutex> lock(mutex);
+    switch (packetType) {
+        case WAITING_STATUS:
+            waitingPacket = packet;
+            break;
+        case MAP_DATA:
+            mapPacket = packet;
+            lastSnapshot.reset();
+            gameOverPacket.reset();
+            break;
+        case GAME_STATE:
+            lastSnapshot = packet;
+            break;
+        case GAME_OVER:
+            gameOverPacket = packet;
+            break;
+        default:
+            break;
+    }
+    fanOut.publish(packet);
+    lock.unlock();
+    fanOut.flush();
+}
+
+bool SpectatorFeed::join(int socket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fanOut.add(socket, {waitingPacket, mapPacket, lastSnapshot, gameOverPacket});
+}
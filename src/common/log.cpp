@@ -0,0 +1,147 @@
+#include "log.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const char* levelName(int level) {
+    switch (level) {
+        case LOG_LEVEL_TRACE:
+            return "TRACE";
+        case LOG_LEVEL_DEBUG:
+            return "DEBUG";
+        case LOG_LEVEL_INFO:
+            return "INFO";
+        default:
+            return "WARN";
+    }
+}
+
+LogLine::~LogLine() {
+    Logger::instance().push(level, text, length);
+}
+
+LogLine& LogLine::append(const char* data, size_t size) {
+    size_t room = MAX_LENGTH - length;
+    if (size > room) {
+        size = room;
+    }
+    std::memcpy(text + length, data, size);
+    length += size;
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const char* value) {
+    if (!value) {
+        return append("(null)", 6);
+    }
+    return append(value, std::strlen(value));
+}
+
+LogLine& LogLine::operator<<(long long value) {
+    char buffer[24];
+    int written = std::snprintf(buffer, sizeof(buffer), "%lld", value);
+    return append(buffer, written);
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+    char buffer[24];
+    int written = std::snprintf(buffer, sizeof(buffer), "%llu", value);
+    return append(buffer, written);
+}
+
+LogLine& LogLine::operator<<(double value) {
+    char buffer[32];
+    int written = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return append(buffer, written);
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    for (size_t i = 0; i < CAPACITY; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    running = false;
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void Logger::push(int level, const char* text, size_t length) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+        slot = &slots[pos % CAPACITY];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->length = length;
+    std::memcpy(slot->text, text, length);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+bool Logger::drain() {
+    char buffer[16384];
+    size_t used = 0;
+    bool any = false;
+
+    while (true) {
+        Slot& slot = slots[dequeuePos % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+            break;
+        }
+        if (used + LogLine::MAX_LENGTH + 16 > sizeof(buffer)) {
+            std::fwrite(buffer, 1, used, stdout);
+            used = 0;
+        }
+        used += std::snprintf(buffer + used, sizeof(buffer) - used, "[%s] %.*s\n",
+            levelName(slot.level), static_cast<int>(slot.length), slot.text);
+        slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+        dequeuePos++;
+        any = true;
+    }
+
+    uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        if (used + 96 > sizeof(buffer)) {
+            std::fwrite(buffer, 1, used, stdout);
+            used = 0;
+        }
+        used += std::snprintf(buffer + used, sizeof(buffer) - used,
+            "[WARN] %llu lignes de log perdues (buffer plein)\n", static_cast<unsigned long long>(lost));
+    }
+    if (used > 0) {
+        std::fwrite(buffer, 1, used, stdout);
+        std::fflush(stdout);
+    }
+    return any;
+}
+
+void Logger::writerLoop() {
+    while (running.load(std::memory_order_relaxed)) {
+        if (!drain()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    drain();
+}
@@ -1,9 +1,10 @@
 #include "map.hpp"
+#include <charconv>
 
 bool Map::loadFromFile(const std::string& filename) {
     std::ifstream file(filename);
     if (!file) {
-        debugPrint("Impossible d'ouvrir le fichier de carte: " + filename);
+        LOG_WARN("Impossible d'ouvrir le fichier de carte: " << filename);
         return false;
     }
     
@@ -15,7 +16,7 @@ bool Map::loadFromFile(const std::string& filename) {
     }
     
     if (lines.empty()) {
-        debugPrint("Carte vide!");
+        LOG_WARN("Carte vide!");
         return false;
     }
     height = lines.size();
@@ -45,7 +46,7 @@ bool Map::loadFromFile(const std::string& filename) {
     }
     
     setupStartPositions();
-    debugPrint("Carte chargée: " + std::to_string(width) + "x" + std::to_string(height));
+    LOG_DEBUG("Carte chargée: " << width << "x" << height);
     return true;
 }
 
@@ -57,6 +58,12 @@ CellType Map::getCell(int x, int y) const
     return data[y * width + x];
 }
 
+void Map::setCell(int x, int y, CellType cellType) {
+    if (x >= 0 && x < width && y >= 0 && y < height) {
+        data[y * width + x] = cellType;
+    }
+}
+
 bool Map::checkCollision(float x, float y, float width, float height, CellType cellType) const {
     int startX = static_cast<int>(x);
     int startY = static_cast<int>(y);
@@ -83,15 +90,13 @@ void Map::setupStartPositions() {
     Vector2 sameStart(startX, startY);
     for (int i = 0; i < MAX_PLAYERS; ++i) {
         startPositions.push_back(sameStart);
-        debugPrint("Position de départ du joueur " + std::to_string(i) + ": (" +
-                   std::to_string(startX) + "," + std::to_string(startY) + ")");
+        LOG_DEBUG("Position de départ du joueur " << i << ": (" << startX << "," << startY << ")");
     }
 }
 
 std::string Map::toString() const {
-    std::string result;
-    
-    result += std::to_string(width) + "," + std::to_string(height) + "\n";
+    std::string result = std::to_string(width) + "," + std::to_string(height) + "\n";
+    result.reserve(result.size() + static_cast<size_t>(width + 1) * height);
     
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
@@ -115,34 +120,50 @@ std::string Map::toString() const {
     return result;
 }
 
+// Parsed in place, one line at a time, without copying the lines out.
 bool Map::fromString(const std::string& mapString) {
-    std::istringstream stream(mapString);
-    std::string line;
     int y = 0;
     int coinCount = 0;
     int electricCount = 0;
     
-    if (!std::getline(stream, line)) {
-        debugPrint("Format de carte invalide: impossible de lire les dimensions");
+    if (mapString.empty()) {
+        LOG_WARN("Format de carte invalide: impossible de lire les dimensions");
         return false;
     }
+    size_t lineEnd = mapString.find('\n');
+    if (lineEnd == std::string::npos) {
+        lineEnd = mapString.size();
+    }
     
-    size_t commaPos = line.find(',');
-    if (commaPos == std::string::npos) {
-        debugPrint("Format de carte invalide: dimensions mal formatées");
+    const char* line = mapString.data();
+    const char* comma = static_cast<const char*>(std::memchr(line, ',', lineEnd));
+    if (!comma) {
+        LOG_WARN("Format de carte invalide: dimensions mal formatées");
         return false;
     }
     
-    width = std::stoi(line.substr(0, commaPos));
-    height = std::stoi(line.substr(commaPos + 1));
+    auto parsedWidth = std::from_chars(line, comma, width);
+    auto parsedHeight = std::from_chars(comma + 1, line + lineEnd, height);
+    if (parsedWidth.ec != std::errc() || parsedHeight.ec != std::errc() || width < 0 || height < 0) {
+        LOG_WARN("Format de carte invalide: dimensions mal formatées");
+        width = 0;
+        height = 0;
+        return false;
+    }
     data.clear();
     data.resize(width * height, EMPTY);
     
-    while (std::getline(stream, line) && y < height) {
-        for (size_t x = 0; x < line.length() && x < static_cast<size_t>(width); x++) {
+    size_t position = lineEnd + 1;
+    while (position < mapString.size() && y < height) {
+        lineEnd = mapString.find('\n', position);
+        if (lineEnd == std::string::npos) {
+            lineEnd = mapString.size();
+        }
+        size_t length = lineEnd - position;
+        for (size_t x = 0; x < length && x < static_cast<size_t>(width); x++) {
             CellType cell = EMPTY;
             
-            switch (line[x]) {
+            switch (mapString[position + x]) {
                 case 'c': 
                     cell = COIN; 
                     coinCount++; 
@@ -157,13 +178,9 @@ bool Map::fromString(const std::string& mapString) {
             }
             data[y * width + x] = cell;
         }
+        position = lineEnd + 1;
         y++;
     }
     setupStartPositions();
-    const std::vector<Vector2>& positions = getStartPositions();
-    for (size_t i = 0; i < positions.size(); i++) {
-        Vector2 pos = positions[i];
-        CellType cellAtStart = getCell(pos.x, pos.y);
-    }
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::ThreadBuffer& Profiler::localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (!buffer) {
+        auto created = std::make_unique<ThreadBuffer>();
+        created->events.resize(EVENTS_PER_THREAD);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        created->threadId = static_cast<int>(threads.size()) + 1;
+        created->name = "thread " + std::to_string(created->threadId);
+        buffer = created.get();
+        threads.push_back(std::move(created));
+    }
+    return *buffer;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer.name = name;
+}
+
+void Profiler::record(const char* name, int64_t startNs, int64_t endNs) {
+    ThreadBuffer& buffer = localBuffer();
+    ProfileEvent& event = buffer.events[buffer.written % EVENTS_PER_THREAD];
+
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    buffer.written++;
+}
+
+void Profiler::recordFrame(int64_t durationNs) {
+    frameTimes[frameCount % FRAME_WINDOW] = durationNs;
+    frameCount++;
+}
+
+FrameStats Profiler::frameStats() const {
+    FrameStats stats;
+    size_t count = std::min(frameCount, FRAME_WINDOW);
+
+    if (count == 0) {
+        return stats;
+    }
+    std::array<int64_t, FRAME_WINDOW> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.begin() + count);
+
+    auto at = [&](double p) {
+        size_t index = std::min(count - 1, static_cast<size_t>(p * count));
+        return sorted[index] / 1e6f;
+    };
+    stats.p50Ms = at(0.50);
+    stats.p95Ms = at(0.95);
+    stats.p99Ms = at(0.99);
+    stats.maxMs = sorted[count - 1] / 1e6f;
+    stats.frames = static_cast<int>(count);
+    return stats;
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Impossible d'écrire la trace: " << filename << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int64_t origin = 0;
+    for (const auto& thread : threads) {
+        size_t count = std::min(thread->written, EVENTS_PER_THREAD);
+        for (size_t i = thread->written - count; i < thread->written; i++) {
+            int64_t start = thread->events[i % EVENTS_PER_THREAD].startNs;
+            if (origin == 0 || start < origin) {
+                origin = start;
+            }
+        }
+    }
+
+    bool firstEntry = true;
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (const auto& thread : threads) {
+        file << (firstEntry ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << thread->threadId << ",\"args\":{\"name\":\"" << thread->name << "\"}}";
+        firstEntry = false;
+
+        size_t count = std::min(thread->written, EVENTS_PER_THREAD);
+        for (size_t i = thread->written - count; i < thread->written; i++) {
+            const ProfileEvent& event = thread->events[i % EVENTS_PER_THREAD];
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+                 << ",\"ts\":" << (event.startNs - origin) / 1000.0
+                 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
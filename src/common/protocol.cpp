@@ -1,73 +1,115 @@
 #include "protocol.hpp"
+#include <algorithm>
+#include <sys/uio.h>
 
-bool Protocol::sendPacket(int socket, int packetType, const void* data, int dataLength)
+void Protocol::writeHeader(char* out, int packetType, int dataLength)
 {
-    PacketHeader header;
-    header.type = packetType;
-    header.length = dataLength;
-    
-    if (send(socket, &header, sizeof(header), 0) != sizeof(header)) {
-        debugPrint("Erreur lors de l'envoi de l'en-tête du paquet");
+    Wire::Writer<Wire::HeaderLayout> header(out);
+    header.set<Wire::HeaderLayout::Type>(packetType);
+    header.set<Wire::HeaderLayout::Version>(Wire::VERSION);
+    header.set<Wire::HeaderLayout::Length>(dataLength);
+}
+
+bool Protocol::readHeader(const char* in, PacketHeader& header)
+{
+    Wire::View<Wire::HeaderLayout> view(in);
+    uint16_t version = view.get<Wire::HeaderLayout::Version>();
+    if (version != Wire::VERSION) {
+        LOG_WARN("Version de protocole incompatible: " << version << " (attendue " << Wire::VERSION << ")");
         return false;
     }
-    if (data && dataLength > 0) {
-        if (send(socket, data, dataLength, 0) != dataLength) {
-            debugPrint("Erreur lors de l'envoi des données du paquet");
-            return false;
-        }
+    header.type = view.get<Wire::HeaderLayout::Type>();
+    header.length = static_cast<int>(view.get<Wire::HeaderLayout::Length>());
+    return true;
+}
+
+bool Protocol::sendPacket(int socket, int packetType, const void* data, int dataLength,
+    TrafficCounters* counters)
+{
+    char header[Wire::HeaderLayout::SIZE];
+    writeHeader(header, packetType, dataLength);
+
+    // Header and payload in one call: another thread sending on the same
+    // socket can then never land between them.
+    struct iovec parts[2] = {{header, sizeof(header)}, {const_cast<void*>(data), static_cast<size_t>(dataLength)}};
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = data && dataLength > 0 ? 2 : 1;
+    ssize_t expected = sizeof(header) + (message.msg_iovlen == 2 ? dataLength : 0);
+    if (sendmsg(socket, &message, MSG_NOSIGNAL) != expected) {
+        LOG_WARN("Erreur lors de l'envoi du paquet");
+        return false;
+    }
+    if (counters) {
+        counters->packetsSent.fetch_add(1, std::memory_order_relaxed);
+        counters->bytesSent.fetch_add(sizeof(header) + dataLength, std::memory_order_relaxed);
     }
     return true;
 }
 
-int Protocol::receivePacket(int socket, int& packetType, void* buffer, int bufferSize)
+int Protocol::receivePacket(int socket, int& packetType, void* buffer, int bufferSize,
+    TrafficCounters* counters)
 {
-    PacketHeader header;
-    int received = recv(socket, &header, sizeof(header), MSG_WAITALL);
-    packetType = header.type;
-    int dataLength = header.length;
+    char headerBytes[Wire::HeaderLayout::SIZE];
+    int received = recv(socket, headerBytes, sizeof(headerBytes), MSG_WAITALL);
 
     if (received <= 0) {
         if (received == 0) {
-            debugPrint("Connexion fermée (recv = 0)");
+            LOG_DEBUG("Connexion fermée (recv = 0)");
         } else {
-            debugPrint("Erreur lors de la réception de l'en-tête du paquet : " + std::string(strerror(errno)));
+            LOG_WARN("Erreur lors de la réception de l'en-tête du paquet : " << strerror(errno));
         }
-        return received;
+        return -1;
+    }
+    if (received < (int)sizeof(headerBytes)) {
+        LOG_WARN("En-tête de paquet incomplet");
+        return -1;
+    }
+    PacketHeader header;
+    if (!readHeader(headerBytes, header)) {
+        return -1;
     }
+    packetType = header.type;
+    int dataLength = header.length;
 
-    if (dataLength > bufferSize) {
-        debugPrint("Données de paquet trop grandes pour le buffer");
+    if (dataLength < 0 || dataLength > bufferSize) {
+        LOG_WARN("Données de paquet trop grandes pour le buffer");
         return -1;
     }
 
     if (dataLength > 0) {
-        received = recv(socket, buffer, dataLength, 0);
+        received = recv(socket, buffer, dataLength, MSG_WAITALL);
         
         if (received <= 0) {
-            debugPrint("Erreur lors de la réception des données du paquet : " + std::string(strerror(errno)));
-            return received;
+            LOG_WARN("Erreur lors de la réception des données du paquet : " << strerror(errno));
+            return -1;
         }
         if (received < dataLength) {
-            debugPrint("Données de paquet incomplètes reçues");
+            LOG_WARN("Données de paquet incomplètes reçues");
             return -1;
         }
     }
+    if (counters) {
+        counters->packetsReceived.fetch_add(1, std::memory_order_relaxed);
+        counters->bytesReceived.fetch_add(sizeof(headerBytes) + dataLength, std::memory_order_relaxed);
+    }
 
     return dataLength;
 }
 
 
-bool Protocol::sendMap(int socket, const Map& map)
+bool Protocol::sendMap(int socket, const Map& map, TrafficCounters* counters)
 {
     std::string mapString = map.toString();
-    debugPrint("Envoi de la carte: " + std::to_string(mapString.length()) + " octets");
+    LOG_DEBUG("Envoi de la carte: " << mapString.length() << " octets");
 
     if (socket < 0) {
-        debugPrint("Socket invalide dans sendMap");
+        LOG_WARN("Socket invalide dans sendMap");
         return false;
     }
 
-    return sendPacket(socket, MAP_DATA, mapString.c_str(), mapString.length());
+    return sendPacket(socket, MAP_DATA, mapString.c_str(), mapString.length(), counters);
 }
 
 
@@ -81,7 +123,7 @@ bool Protocol::receiveMap(int socket, Map& map)
         return false;
     }
     if (packetType != MAP_DATA) {
-        debugPrint("Type de paquet inattendu pour la carte");
+        LOG_WARN("Type de paquet inattendu pour la carte");
         return false;
     }
     buffer[dataSize] = '\0';
@@ -90,78 +132,270 @@ bool Protocol::receiveMap(int socket, Map& map)
 
 bool Protocol::sendPlayerPosition(int socket, int playerId, const Vector2& position, bool jetpackOn)
 {
-    struct {
-        int player_id;
-        float x;
-        float y;
-        int jetpack_on;
-    } data;
+    using Layout = Wire::PlayerPositionLayout;
+    char data[Layout::SIZE];
+    Wire::Writer<Layout> writer(data);
+    writer.set<Layout::PlayerId>(playerId);
+    writer.set<Layout::X>(position.x);
+    writer.set<Layout::Y>(position.y);
+    writer.set<Layout::JetpackOn>(jetpackOn ? 1 : 0);
     
-    data.player_id = playerId;
-    data.x = position.x;
-    data.y = position.y;
-    data.jetpack_on = jetpackOn ? 1 : 0;
+    LOG_TRACE("Envoi du paquet PLAYER_POS: id=" << playerId << ", jetpack=" << jetpackOn);
     
-    debugPrint("Envoi du paquet PLAYER_POS: id=" + std::to_string(playerId) +
-              ", jetpack=" + std::to_string(data.jetpack_on));
-    
-    return sendPacket(socket, PLAYER_POS, &data, sizeof(data));
+    return sendPacket(socket, PLAYER_POS, data, sizeof(data));
 }
 
-bool Protocol::sendGameState(int socket, GameState state, const std::array<Player, MAX_PLAYERS>& players)
+namespace {
+    void writePlayerState(Wire::Writer<Wire::PlayerStateLayout> writer, const Player& player)
+    {
+        using Layout = Wire::PlayerStateLayout;
+        writer.set<Layout::Id>(player.id);
+        writer.set<Layout::X>(player.position.x);
+        writer.set<Layout::Y>(player.position.y);
+        writer.set<Layout::Score>(player.score);
+        writer.set<Layout::Alive>(player.alive ? 1 : 0);
+        writer.set<Layout::JetpackOn>(player.jetpackOn ? 1 : 0);
+    }
+
+    void writeGameState(char* out, GameState state, const std::array<Player, MAX_PLAYERS>& players)
+    {
+        using Layout = Wire::GameStateLayout;
+        Wire::Writer<Layout> writer(out);
+        writer.set<Layout::State>(state);
+        writer.set<Layout::Count>(MAX_PLAYERS);
+
+        for (int i = 0; i < MAX_PLAYERS; ++i) {
+            writePlayerState(writer.at<Layout::Players>(i), players[i]);
+        }
+    }
+
+    void writeGameOver(char* out, int winnerId, const std::array<int, MAX_PLAYERS>& scores)
+    {
+        using Layout = Wire::GameOverLayout;
+        Wire::Writer<Layout> writer(out);
+        writer.set<Layout::WinnerId>(winnerId);
+        for (int i = 0; i < MAX_PLAYERS; ++i) {
+            writer.set<Layout::Scores>(i, scores[i]);
+        }
+    }
+
+    // Allocates a packet, or takes one from the pool, and writes its header;
+    // the caller writes the payload in place after Wire::HeaderLayout::SIZE bytes.
+    std::shared_ptr<std::vector<char>> allocatePacket(int packetType, int dataLength, PacketPool* pool = nullptr)
+    {
+        size_t size = Wire::HeaderLayout::SIZE + dataLength;
+        auto packet = pool ? pool->acquire(size) : std::make_shared<std::vector<char>>(size);
+        Protocol::writeHeader(packet->data(), packetType, dataLength);
+        return packet;
+    }
+}
+
+bool Protocol::sendGameState(int socket, GameState state, const std::array<Player, MAX_PLAYERS>& players,
+    TrafficCounters* counters)
 {
-    struct {
-        int game_state;
-        struct {
-            int player_id;
-            float x;
-            float y;
-            int score;
-            int alive;
-            int jetpackOn;
-        } players[MAX_PLAYERS];
-    } data;
+    char data[Wire::GameStateLayout::SIZE];
+    writeGameState(data, state, players);
+    return sendPacket(socket, GAME_STATE, data, sizeof(data), counters);
+}
 
-    data.game_state = state;
+bool Protocol::sendGameOver(int socket, int winnerId, const std::array<int, MAX_PLAYERS>& scores,
+    TrafficCounters* counters)
+{
+    char data[Wire::GameOverLayout::SIZE];
+    writeGameOver(data, winnerId, scores);
+    return sendPacket(socket, GAME_OVER, data, sizeof(data), counters);
+}
 
-    for (int i = 0; i < MAX_PLAYERS; ++i) {
-        data.players[i].player_id = players[i].id;
-        data.players[i].x = players[i].position.x;
-        data.players[i].y = players[i].position.y;
-        data.players[i].score = players[i].score;
-        data.players[i].alive = players[i].alive ? 1 : 0;
-        data.players[i].jetpackOn = players[i].jetpackOn ? 1 : 0;
+bool Protocol::sendWaitingStatus(int socket, int connectedPlayers, TrafficCounters* counters)
+{
+    return sendInt(socket, WAITING_STATUS, connectedPlayers, counters);
+}
+
+bool Protocol::sendInt(int socket, int packetType, int value, TrafficCounters* counters)
+{
+    char data[Wire::IntLayout::SIZE];
+    Wire::Writer<Wire::IntLayout>(data).set<Wire::IntLayout::Value>(value);
+    return sendPacket(socket, packetType, data, sizeof(data), counters);
+}
+
+SharedPacket Protocol::encodePacket(int packetType, const void* data, int dataLength)
+{
+    auto packet = allocatePacket(packetType, dataLength);
+    if (data && dataLength > 0) {
+        std::memcpy(packet->data() + Wire::HeaderLayout::SIZE, data, dataLength);
     }
-    bool result = sendPacket(socket, GAME_STATE, &data, sizeof(data));
-    return result;
+    return packet;
 }
 
-bool Protocol::sendGameOver(int socket, int winnerId, const std::array<int, MAX_PLAYERS>& scores)
+SharedPacket Protocol::encodeGameState(GameState state, const std::array<Player, MAX_PLAYERS>& players,
+    PacketPool* pool)
 {
-    struct {
-        int winner_id;
-        int scores[MAX_PLAYERS];
-    } data;
-    
-    data.winner_id = winnerId;
-    
+    auto packet = allocatePacket(GAME_STATE, Wire::GameStateLayout::SIZE, pool);
+    writeGameState(packet->data() + Wire::HeaderLayout::SIZE, state, players);
+    return packet;
+}
+
+SharedPacket Protocol::encodeGameState(GameState state, const std::array<Player, MAX_PLAYERS>& players,
+    const std::vector<int>& visible, PacketPool* pool)
+{
+    using Layout = Wire::GameStateLayout;
+    auto packet = allocatePacket(GAME_STATE, Layout::sizeFor(visible.size()), pool);
+    Wire::Writer<Layout> writer(packet->data() + Wire::HeaderLayout::SIZE);
+    writer.set<Layout::State>(state);
+    writer.set<Layout::Count>(visible.size());
+    for (size_t i = 0; i < visible.size(); ++i) {
+        writePlayerState(writer.at<Layout::Players>(i), players[visible[i]]);
+    }
+    return packet;
+}
+
+SharedPacket Protocol::encodeLeaderboard(const std::array<Player, MAX_PLAYERS>& players, PacketPool* pool)
+{
+    using Layout = Wire::LeaderboardLayout;
+    using EntryLayout = Wire::LeaderboardEntryLayout;
+    auto packet = allocatePacket(LEADERBOARD, Layout::SIZE, pool);
+    Wire::Writer<Layout> writer(packet->data() + Wire::HeaderLayout::SIZE);
     for (int i = 0; i < MAX_PLAYERS; ++i) {
-        data.scores[i] = scores[i];
+        Wire::Writer<EntryLayout> entry = writer.at<Layout::Entries>(i);
+        entry.set<EntryLayout::Score>(players[i].score);
+        entry.set<EntryLayout::Alive>(players[i].alive ? 1 : 0);
     }
-    
-    return sendPacket(socket, GAME_OVER, &data, sizeof(data));
+    return packet;
 }
 
-bool Protocol::sendWaitingStatus(int socket, int connectedPlayers)
+SharedPacket Protocol::encodeGameOver(int winnerId, const std::array<int, MAX_PLAYERS>& scores,
+    PacketPool* pool)
 {
-    return sendPacket(socket, WAITING_STATUS, &connectedPlayers, sizeof(int));
+    auto packet = allocatePacket(GAME_OVER, Wire::GameOverLayout::SIZE, pool);
+    writeGameOver(packet->data() + Wire::HeaderLayout::SIZE, winnerId, scores);
+    return packet;
 }
 
-inline bool sendInt(int socket, int type, int value)
+SharedPacket Protocol::encodePing(int64_t sentUs, int64_t rttUs, int64_t jitterUs, int snapshotInterval,
+    PacketPool* pool)
 {
-    char payload[sizeof(int)];
-    std::memcpy(payload, &value, sizeof(int));
-    return Protocol::sendPacket(socket, type, payload, sizeof(int));
+    using Layout = Wire::PingLayout;
+    auto packet = allocatePacket(PING, Layout::SIZE, pool);
+    Wire::Writer<Layout> writer(packet->data() + Wire::HeaderLayout::SIZE);
+    writer.set<Layout::SentUs>(sentUs);
+    writer.set<Layout::RttUs>(std::clamp<int64_t>(rttUs, 0, UINT32_MAX));
+    writer.set<Layout::JitterUs>(std::clamp<int64_t>(jitterUs, 0, UINT32_MAX));
+    writer.set<Layout::SnapshotInterval>(snapshotInterval);
+    return packet;
 }
 
+SharedPacket Protocol::encodeInt(int packetType, int value)
+{
+    auto packet = allocatePacket(packetType, Wire::IntLayout::SIZE);
+    Wire::Writer<Wire::IntLayout>(packet->data() + Wire::HeaderLayout::SIZE).set<Wire::IntLayout::Value>(value);
+    return packet;
+}
+
+// Scans round-robin from where the last search stopped: buffers are freed
+// roughly in the order they were handed out, so the next one is usually free.
+std::shared_ptr<std::vector<char>> PacketPool::acquire(size_t size)
+{
+    for (size_t scanned = 0; scanned < buffers.size(); scanned++) {
+        std::shared_ptr<std::vector<char>>& buffer = buffers[next];
+        next = (next + 1) % buffers.size();
+        if (buffer.use_count() == 1) {
+            // The last holder may have dropped it on another thread: order
+            // its release before this thread writes into the buffer again.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            buffer->resize(size);
+            return buffer;
+        }
+    }
+
+    auto buffer = std::make_shared<std::vector<char>>();
+    buffer->reserve(std::max(size, bufferCapacity));
+    buffer->resize(size);
+    if (buffers.size() < PACKET_POOL_SIZE) {
+        buffers.push_back(buffer);
+    }
+    return buffer;
+}
 
+bool PacketBacklog::push(const SharedPacket& packet)
+{
+    if (queued == ring.size()) {
+        return false;
+    }
+    ring[(head + queued++) % ring.size()] = packet;
+    pendingBytes += packet->size();
+    return true;
+}
+
+void PacketBacklog::clear()
+{
+    while (queued > 0) {
+        ring[head].reset();
+        head = (head + 1) % ring.size();
+        queued--;
+    }
+    offset = 0;
+    pendingBytes = 0;
+}
+
+size_t PacketBacklog::gather(iovec* parts, size_t maxParts) const
+{
+    size_t count = std::min(queued, maxParts);
+    for (size_t i = 0; i < count; i++) {
+        const std::vector<char>& bytes = *ring[(head + i) % ring.size()];
+        size_t skip = i == 0 ? offset : 0;
+        parts[i] = {const_cast<char*>(bytes.data()) + skip, bytes.size() - skip};
+    }
+    return count;
+}
+
+void PacketBacklog::consume(size_t sent, TrafficCounters* counters)
+{
+    if (counters) {
+        counters->bytesSent.fetch_add(sent, std::memory_order_relaxed);
+    }
+    pendingBytes -= std::min(sent, pendingBytes);
+    while (sent > 0 && queued > 0) {
+        size_t remaining = ring[head]->size() - offset;
+        if (sent < remaining) {
+            offset += sent;
+            return;
+        }
+        sent -= remaining;
+        offset = 0;
+        ring[head].reset();
+        head = (head + 1) % ring.size();
+        queued--;
+        if (counters) {
+            counters->packetsSent.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool PacketBacklog::flush(int socket, TrafficCounters* counters)
+{
+    const size_t MAX_PARTS = 64;
+    iovec parts[MAX_PARTS];
+    while (queued > 0) {
+        struct msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = parts;
+        message.msg_iovlen = gather(parts, MAX_PARTS);
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        size_t offered = 0;
+        for (size_t i = 0; i < message.msg_iovlen; i++) {
+            offered += parts[i].iov_len;
+        }
+        consume(sent, counters);
+        // A short send means the socket buffer is full.
+        if (static_cast<size_t>(sent) < offered) {
+            return true;
+        }
+    }
+    return true;
+}
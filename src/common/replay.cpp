@@ -0,0 +1,257 @@
+#include "replay.hpp"
+#include "bytes.hpp"
+#include <iterator>
+
+namespace {
+    uint32_t jetpackMaskOf(const Simulation& simulation) {
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (simulation.getPlayers()[i].jetpackOn) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+    }
+
+    uint32_t connectedMaskOf(const Simulation& simulation) {
+        uint32_t mask = 0;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (simulation.isConnected(i)) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+    }
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (file.is_open()) {
+        flush();
+    }
+}
+
+bool ReplayWriter::open(const std::string& filename, const Simulation& simulation, int interval) {
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir le fichier de replay: " << filename << std::endl;
+        return false;
+    }
+
+    std::string mapString = simulation.getMap().toString();
+    keyframeInterval = interval > 0 ? interval : Simulation::TICKS_PER_SECOND;
+    lastJetpackMask = jetpackMaskOf(simulation);
+    lastConnectedMask = connectedMaskOf(simulation);
+    index.clear();
+    buffer.clear();
+    offset = 0;
+
+    ByteWriter writer(buffer);
+    writer.bytes("JPRP", 4);
+    writer.u32(Replay::VERSION);
+    writer.u64(simulation.getSeed());
+    writer.u64(fnv1a64(mapString.data(), mapString.size()));
+    writer.u32(MAX_PLAYERS);
+    writer.u32(keyframeInterval);
+    writer.u32(mapString.size());
+    writer.bytes(mapString.data(), mapString.size());
+    flush();
+    return true;
+}
+
+void ReplayWriter::recordTick(const Simulation& simulation) {
+    if (!file.is_open()) {
+        return;
+    }
+    ByteWriter writer(buffer);
+    uint32_t tick = simulation.getTick();
+
+    uint32_t jetpackMask = jetpackMaskOf(simulation);
+    uint32_t connectedMask = connectedMaskOf(simulation);
+    if (jetpackMask != lastJetpackMask || connectedMask != lastConnectedMask) {
+        writer.u8(Replay::RECORD_INPUT);
+        writer.u32(tick);
+        writer.u32(jetpackMask);
+        writer.u32(connectedMask);
+        lastJetpackMask = jetpackMask;
+        lastConnectedMask = connectedMask;
+    }
+
+    if (tick % keyframeInterval == 0) {
+        index.emplace_back(tick, offset + buffer.size());
+        state.clear();
+        simulation.serialize(state);
+        writer.u8(Replay::RECORD_KEYFRAME);
+        writer.u32(tick);
+        writer.u32(state.size());
+        writer.bytes(state.data(), state.size());
+    }
+    if (buffer.size() >= 64 * 1024) {
+        flush();
+    }
+}
+
+void ReplayWriter::finish(const Simulation& simulation) {
+    if (!file.is_open()) {
+        return;
+    }
+    ByteWriter writer(buffer);
+    writer.u8(Replay::RECORD_END);
+    writer.u32(simulation.getTick());
+    writer.i32(simulation.getWinnerId());
+
+    uint64_t indexOffset = offset + buffer.size();
+    writer.u32(index.size());
+    for (const auto& entry : index) {
+        writer.u32(entry.first);
+        writer.u64(entry.second);
+    }
+    writer.u64(indexOffset);
+    writer.bytes("JPIX", 4);
+    flush();
+    file.close();
+}
+
+void ReplayWriter::flush() {
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.flush();
+    offset += buffer.size();
+    buffer.clear();
+}
+
+bool ReplayReader::open(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible d'ouvrir le replay: " << filename << std::endl;
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    ByteReader reader(data.data(), data.size());
+    const uint8_t* magic = reader.bytes(4);
+    if (!magic || std::memcmp(magic, "JPRP", 4) != 0) {
+        std::cerr << "Fichier de replay invalide: " << filename << std::endl;
+        return false;
+    }
+    uint32_t version = reader.u32();
+    seed = reader.u64();
+    uint64_t mapHash = reader.u64();
+    uint32_t playerCount = reader.u32();
+    keyframeInterval = reader.u32();
+    uint32_t mapLength = reader.u32();
+    const uint8_t* mapText = reader.bytes(mapLength);
+    if (!reader.ok() || version != Replay::VERSION || playerCount != MAX_PLAYERS) {
+        std::cerr << "Version de replay non supportée: " << filename << std::endl;
+        return false;
+    }
+    std::string mapString(reinterpret_cast<const char*>(mapText), mapLength);
+    if (fnv1a64(mapString.data(), mapString.size()) != mapHash || !map.fromString(mapString)) {
+        std::cerr << "Carte du replay corrompue: " << filename << std::endl;
+        return false;
+    }
+    recordsBegin = reader.position();
+    recordsEnd = data.size();
+
+    if (!readIndex()) {
+        LOG_INFO("Replay sans index, reconstruction par parcours");
+        scanIndex();
+    }
+    return true;
+}
+
+bool ReplayReader::readIndex() {
+    if (data.size() < recordsBegin + Replay::FOOTER_SIZE) {
+        return false;
+    }
+    ByteReader footer(data.data() + data.size() - Replay::FOOTER_SIZE, Replay::FOOTER_SIZE);
+    uint64_t indexOffset = footer.u64();
+    const uint8_t* magic = footer.bytes(4);
+    if (!magic || std::memcmp(magic, "JPIX", 4) != 0 || indexOffset < recordsBegin ||
+        indexOffset > data.size() - Replay::FOOTER_SIZE) {
+        return false;
+    }
+
+    ByteReader reader(data.data() + indexOffset, data.size() - Replay::FOOTER_SIZE - indexOffset);
+    uint32_t count = reader.u32();
+    index.clear();
+    for (uint32_t i = 0; i < count && reader.ok(); i++) {
+        uint32_t tick = reader.u32();
+        uint64_t entryOffset = reader.u64();
+        index.emplace_back(tick, entryOffset);
+    }
+    if (!reader.ok() || reader.remaining() != 0) {
+        index.clear();
+        return false;
+    }
+    recordsEnd = indexOffset;
+    indexed = true;
+    return true;
+}
+
+void ReplayReader::scanIndex() {
+    // A server that died mid-match leaves no index; rebuild it from the records.
+    index.clear();
+    size_t cursor = recordsBegin;
+    ReplayRecord record;
+    size_t recordStart = cursor;
+    while (next(cursor, record)) {
+        if (record.type == Replay::RECORD_KEYFRAME) {
+            index.emplace_back(record.tick, recordStart);
+        }
+        recordStart = cursor;
+    }
+}
+
+bool ReplayReader::next(size_t& cursor, ReplayRecord& record) const {
+    if (cursor >= recordsEnd) {
+        return false;
+    }
+    ByteReader reader(data.data() + cursor, recordsEnd - cursor);
+    record = ReplayRecord();
+    record.type = reader.u8();
+    record.tick = reader.u32();
+    switch (record.type) {
+        case Replay::RECORD_INPUT:
+            record.jetpackMask = reader.u32();
+            record.connectedMask = reader.u32();
+            break;
+        case Replay::RECORD_KEYFRAME:
+            record.stateSize = reader.u32();
+            record.state = reader.bytes(record.stateSize);
+            break;
+        case Replay::RECORD_END:
+            record.winnerId = reader.i32();
+            break;
+        default:
+            return false;
+    }
+    if (!reader.ok()) {
+        return false;
+    }
+    cursor += reader.position();
+    return true;
+}
+
+bool ReplayReader::seek(Simulation& simulation, uint32_t tick, size_t& cursor) const {
+    simulation.start(map, seed);
+    cursor = recordsBegin;
+
+    const std::pair<uint32_t, uint64_t>* best = nullptr;
+    for (const auto& entry : index) {
+        if (entry.first > tick) {
+            break;
+        }
+        best = &entry;
+    }
+    if (!best) {
+        return true;
+    }
+
+    size_t keyframeCursor = best->second;
+    ReplayRecord record;
+    if (!next(keyframeCursor, record) || record.type != Replay::RECORD_KEYFRAME ||
+        !simulation.deserialize(record.state, record.stateSize)) {
+        return false;
+    }
+    cursor = keyframeCursor;
+    return true;
+}
@@ -0,0 +1,259 @@
+#include "session.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+
+ClientSession::ClientSession(const std::string& serverIP, int port)
+    : serverIP(serverIP), port(port) {
+    for (int i = 0; i < MAX_PLAYERS; ++i) {
+        netState.players[i].id = i;
+        netState.players[i].alive = true;
+    }
+}
+
+ClientSession::~ClientSession() {
+    disconnect();
+}
+
+bool ClientSession::connect() {
+    clientSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (clientSocket < 0) {
+        std::cerr << "Erreur lors de la création du socket" << std::endl;
+        return false;
+    }
+ 
+    struct sockaddr_in serverAddr;
+    std::memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(port);
+ 
+    if (inet_pton(AF_INET, serverIP.c_str(), &serverAddr.sin_addr) <= 0) {
+        std::cerr << "Adresse IP invalide: " << serverIP << std::endl;
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+ 
+    if (::connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+        std::cerr << "Erreur lors de la connexion au serveur" << std::endl;
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+ 
+    std::cout << "Connecté au serveur " << serverIP << ":" << port << std::endl;
+ 
+    // READY may carry a skill rating for matchmaking; without one the
+    // server uses its default.
+    bool sent = spectator || skillRating < 0 ? Protocol::sendPacket(clientSocket, spectator ? SPECTATE : READY)
+        : Protocol::sendInt(clientSocket, READY, skillRating);
+    if (!sent) {
+        std::cerr << "Erreur lors de l'envoi du paquet " << (spectator ? "SPECTATE" : "READY") << std::endl;
+        close(clientSocket);
+        clientSocket = -1;
+        return false;
+    }
+ 
+    return true;
+}
+
+void ClientSession::disconnect() {
+    if (clientSocket >= 0) {
+        close(clientSocket);
+        clientSocket = -1;
+    }
+}
+
+int ClientSession::poll(int timeoutMs) {
+    if (clientSocket < 0) {
+        std::cerr << "Socket invalide dans ClientSession::poll" << std::endl;
+        return -1;
+    }
+
+    char buffer[MAX_BUFFER_SIZE];
+    int packetType;
+
+    struct pollfd pfd = {clientSocket, POLLIN, 0};
+    int ret = ::poll(&pfd, 1, timeoutMs);
+
+    if (ret < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        std::cerr << "Erreur de poll: " << strerror(errno) << std::endl;
+        return 0;
+    }
+
+    if (ret == 0) return 0;
+
+    PROFILE_SCOPE("session.receive");
+    int dataSize = Protocol::receivePacket(clientSocket, packetType, buffer, MAX_BUFFER_SIZE);
+    if (dataSize < 0) {
+        LOG_DEBUG("Connexion fermée par le serveur");
+        return -1;
+    }
+
+    handleServerMessage(packetType, buffer, dataSize);
+    return 1;
+}
+
+bool ClientSession::sendPlayerPosition(const ClientSnapshot& snapshot, bool jetpackOn) const {
+    if (snapshot.myPlayerId < 0 || snapshot.myPlayerId >= MAX_PLAYERS) {
+        return false;
+    }
+
+    if (clientSocket < 0 || snapshot.gameState != RUNNING) {
+        return false;
+    }
+
+    return Protocol::sendPlayerPosition(clientSocket, snapshot.myPlayerId,
+        snapshot.players[snapshot.myPlayerId].position, jetpackOn);
+}
+
+void ClientSession::handleServerMessage(int packetType, char* buffer, int dataSize) {
+    switch (packetType) {
+        case ASSIGN_PLAYER_ID: {
+            if (dataSize < (int)Wire::IntLayout::SIZE) {
+                LOG_WARN("Paquet ASSIGN_PLAYER_ID invalide");
+                break;
+            }
+
+            int assignedId = Wire::View<Wire::IntLayout>(buffer).get<Wire::IntLayout::Value>();
+            if (assignedId < 0 || assignedId >= MAX_PLAYERS) {
+                LOG_WARN("ID de joueur assigné invalide: " << assignedId);
+                break;
+            }
+
+            netState.myPlayerId = assignedId;
+            LOG_DEBUG("[INIT] Mon playerId assigné par le serveur: " << assignedId);
+            break;
+        }
+
+        case MAP_DATA: {
+            std::string mapString(buffer, dataSize);
+            LOG_TRACE("[MAP] Données reçues:\n" << mapString);
+
+            auto map = std::make_shared<Map>();
+            if (map->fromString(mapString)) {
+                netState.map = map;
+                LOG_DEBUG("Carte chargée avec succès");
+            } else {
+                LOG_WARN("Erreur lors du chargement de la carte");
+            }
+            break;
+        }
+
+        case GAME_STATE: {
+            using Layout = Wire::GameStateLayout;
+            using PlayerLayout = Wire::PlayerStateLayout;
+            Wire::View<Layout> state(buffer);
+            int count = dataSize >= (int)Layout::sizeFor(0) ? state.get<Layout::Count>() : -1;
+            if (count < 0 || count > MAX_PLAYERS || dataSize < (int)Layout::sizeFor(count)) {
+                LOG_WARN("Paquet GAME_STATE invalide");
+                break;
+            }
+
+            netState.gameState = static_cast<GameState>(state.get<Layout::State>());
+            
+            // Players outside our area of interest are left out; they keep
+            // their last known state until they come back into range.
+            for (int i = 0; i < count; i++) {
+                Wire::View<PlayerLayout> playerData = state.at<Layout::Players>(i);
+                int id = playerData.get<PlayerLayout::Id>();
+                if (id >= 0 && id < MAX_PLAYERS) {
+                    Player& player = netState.players[id];
+                    player.id = id;
+                    player.position.x = playerData.get<PlayerLayout::X>();
+                    player.position.y = playerData.get<PlayerLayout::Y>();
+                    player.score = playerData.get<PlayerLayout::Score>();
+                    player.alive = playerData.get<PlayerLayout::Alive>() != 0;
+                    
+                    if (id != netState.myPlayerId) {
+                        player.jetpackOn = playerData.get<PlayerLayout::JetpackOn>() != 0;
+                    }
+                    
+                    if (netState.myPlayerId == -1 && !spectator) {
+                        netState.myPlayerId = id;
+                        LOG_DEBUG("Mon ID de joueur: " << id);
+                    }
+                }
+            }
+            break;
+        }
+
+        case LEADERBOARD: {
+            using Layout = Wire::LeaderboardLayout;
+            using EntryLayout = Wire::LeaderboardEntryLayout;
+            if (dataSize < (int)Layout::SIZE) {
+                LOG_WARN("Paquet LEADERBOARD invalide");
+                break;
+            }
+
+            Wire::View<Layout> leaderboard(buffer);
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                Wire::View<EntryLayout> entry = leaderboard.at<Layout::Entries>(i);
+                netState.players[i].score = entry.get<EntryLayout::Score>();
+                netState.players[i].alive = entry.get<EntryLayout::Alive>() != 0;
+            }
+            break;
+        }
+
+        case GAME_OVER: {
+            using Layout = Wire::GameOverLayout;
+            if (dataSize < (int)Layout::SIZE) {
+                LOG_WARN("Paquet GAME_OVER invalide");
+                break;
+            }
+
+            Wire::View<Layout> data(buffer);
+            int winnerId = data.get<Layout::WinnerId>();
+            netState.gameState = OVER;
+            netState.winnerId = winnerId;
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                netState.players[i].score = data.get<Layout::Scores>(i);
+            }
+
+            std::string message = "Fin de partie! ";
+            if (winnerId >= 0 && winnerId < MAX_PLAYERS) {
+                message += "Joueur " + std::to_string(winnerId + 1) + " a gagné avec " +
+                           std::to_string(data.get<Layout::Scores>(winnerId)) + " points!";
+            } else {
+                message += "Pas de gagnant.";
+            }
+            std::cout << message << std::endl;
+            break;
+        }
+
+        case PING: {
+            using Layout = Wire::PingLayout;
+            if (dataSize < (int)Layout::SIZE) {
+                LOG_WARN("Paquet PING invalide");
+                break;
+            }
+
+            Wire::View<Layout> ping(buffer);
+            char pong[Wire::PongLayout::SIZE];
+            Wire::Writer<Wire::PongLayout>(pong).set<Wire::PongLayout::SentUs>(ping.get<Layout::SentUs>());
+            Protocol::sendPacket(clientSocket, PONG, pong, sizeof(pong));
+
+            uint32_t rttUs = ping.get<Layout::RttUs>();
+            netState.rttUs = rttUs > 0 ? rttUs : -1;
+            netState.jitterUs = ping.get<Layout::JitterUs>();
+            netState.snapshotInterval = std::max<int>(1, ping.get<Layout::SnapshotInterval>());
+            break;
+        }
+
+        case WAITING_STATUS: {
+            if (dataSize < (int)Wire::IntLayout::SIZE) {
+                LOG_WARN("Paquet WAITING_STATUS invalide");
+                break;
+            }
+
+            netState.waitingPlayers = Wire::View<Wire::IntLayout>(buffer).get<Wire::IntLayout::Value>();
+            netState.gameState = WAITING;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,235 @@
+#include "simulation.hpp"
+#include "bytes.hpp"
+#include <chrono>
+
+void Simulation::start(const Map& startMap, uint64_t matchSeed) {
+    map = startMap;
+    seed = matchSeed;
+    state = RUNNING;
+    winnerId = -1;
+    tick = 0;
+
+    const std::vector<Vector2>& startPositions = map.getStartPositions();
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        players[i] = Player();
+        players[i].id = i;
+        if (static_cast<size_t>(i) < startPositions.size()) {
+            players[i].position.x = startPositions[i].x * CELL_SIZE;
+            players[i].position.y = startPositions[i].y * CELL_SIZE;
+        }
+        connected[i] = true;
+    }
+}
+
+void Simulation::step() {
+    if (state != RUNNING) {
+        return;
+    }
+
+    bool gracePeriod = inGracePeriod();
+    if (tick == GRACE_TICKS) {
+        LOG_DEBUG("Période de grâce terminée");
+    }
+
+    collisionNs = 0;
+    updateGameState();
+    if (gracePeriod) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (!players[i].alive && connected[i]) {
+                players[i].alive = true;
+                LOG_DEBUG("[RESURRECTION] Joueur " << i << " ressuscité pendant la période de grâce");
+            }
+        }
+    }
+    tick++;
+}
+
+void Simulation::setJetpack(int playerIndex, bool jetpackOn) {
+    players[playerIndex].jetpackOn = jetpackOn;
+}
+
+void Simulation::disconnectPlayer(int playerIndex) {
+    connected[playerIndex] = false;
+    players[playerIndex].alive = false;
+    if (state == RUNNING) {
+        checkGameEndCondition();
+    }
+}
+
+void Simulation::updateGameState() {
+    const float FLOOR_Y = 486.0f;
+    const float JET_ACCEL = -1.5f;
+    const float GRAV_ACCEL = 0.5f;
+    const float HORIZ_SPEED = 4.0f;
+    const float MAX_FALL = 10.0f;
+    const float MAX_RISE = -10.0f;
+    const float DAMP_FACTOR = 0.97f;
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!players[i].alive) 
+            continue;
+
+        if (players[i].jetpackOn) {
+            players[i].velocityY += JET_ACCEL;
+        }
+        players[i].velocityY += GRAV_ACCEL;
+        players[i].velocityY *= DAMP_FACTOR;
+        
+        if (players[i].velocityY > MAX_FALL) {
+            players[i].velocityY = MAX_FALL;
+        } else if (players[i].velocityY < MAX_RISE) {
+            players[i].velocityY = MAX_RISE;
+        }
+        
+        players[i].position.y += players[i].velocityY;
+        players[i].position.x += HORIZ_SPEED;
+        
+        if (players[i].position.y < 0) {
+            players[i].position.y = 0;
+            players[i].velocityY = 0;
+        } else if (players[i].position.y > FLOOR_Y) {
+            players[i].position.y = FLOOR_Y;
+            players[i].velocityY = 0;
+        }
+
+        bool wasAlive = players[i].alive;
+        if (collisionTiming) {
+            auto collisionStart = std::chrono::steady_clock::now();
+            checkCollisions(i);
+            collisionNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - collisionStart).count();
+        } else {
+            checkCollisions(i);
+        }
+        if (wasAlive && !players[i].alive) {
+            LOG_DEBUG("Joueur " << i << " est mort lors de checkCollisions");
+            continue;
+        }
+        
+        if (players[i].position.x >= map.getWidth() * CELL_SIZE - PLAYER_WIDTH) {
+            LOG_DEBUG("Joueur " << i << " a atteint la fin du niveau");
+            endGame(i);
+            return;
+        }
+    }
+}
+
+void Simulation::checkCollisions(int playerIndex) {
+    Player& player = players[playerIndex];
+    
+    int startTileX = static_cast<int>(player.position.x / CELL_SIZE);
+    int endTileX = static_cast<int>((player.position.x + PLAYER_WIDTH - 1) / CELL_SIZE);
+    int startTileY = static_cast<int>(player.position.y / CELL_SIZE);
+    int endTileY = static_cast<int>((player.position.y + PLAYER_HEIGHT - 1) / CELL_SIZE);
+    
+    for (int tileY = startTileY; tileY <= endTileY; tileY++) {
+        for (int tileX = startTileX; tileX <= endTileX; tileX++) {
+            if (tileX < 0 || tileX >= map.getWidth() || tileY < 0 || tileY >= map.getHeight()) {
+                continue;
+            }
+            
+            CellType cell = map.getCell(tileX, tileY);
+            
+            if (cell == COIN) {
+                player.score++;
+                map.setCell(tileX, tileY, EMPTY);
+            } 
+            else if (cell == ELECTRIC) {
+                player.alive = false;
+                checkGameEndCondition();
+                return;
+            }
+        }
+    }
+}
+
+void Simulation::endGame(int winner) {
+    if (state != RUNNING) {
+        return;
+    }
+    LOG_DEBUG("Fin de partie, gagnant: Joueur " << winner);
+    state = OVER;
+    winnerId = winner;
+}
+
+void Simulation::checkGameEndCondition() {
+    int aliveCount = 0;
+    int lastAlivePlayer = -1;
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (players[i].alive) {
+            aliveCount++;
+            lastAlivePlayer = i;
+        }
+    }
+    
+    if (aliveCount <= 1 && state == RUNNING) {
+        endGame(lastAlivePlayer);
+    }
+}
+
+void Simulation::serialize(std::vector<uint8_t>& out) const {
+    ByteWriter writer(out);
+
+    writer.u32(tick);
+    writer.u8(state);
+    writer.i32(winnerId);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const Player& player = players[i];
+        writer.f32(player.position.x);
+        writer.f32(player.position.y);
+        writer.f32(player.velocityY);
+        writer.i32(player.score);
+        writer.u8((player.alive ? 1 : 0) | (player.jetpackOn ? 2 : 0) | (connected[i] ? 4 : 0));
+    }
+    writer.u32(map.getWidth());
+    writer.u32(map.getHeight());
+    for (int y = 0; y < map.getHeight(); y++) {
+        for (int x = 0; x < map.getWidth(); x++) {
+            writer.u8(map.getCell(x, y));
+        }
+    }
+}
+
+bool Simulation::deserialize(const uint8_t* data, size_t size) {
+    ByteReader reader(data, size);
+
+    int newTick = reader.u32();
+    GameState newState = static_cast<GameState>(reader.u8());
+    int newWinner = reader.i32();
+    std::array<Player, MAX_PLAYERS> newPlayers;
+    std::array<bool, MAX_PLAYERS> newConnected;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Player& player = newPlayers[i];
+        player.id = i;
+        player.position.x = reader.f32();
+        player.position.y = reader.f32();
+        player.velocityY = reader.f32();
+        player.score = reader.i32();
+        uint8_t flags = reader.u8();
+        player.alive = flags & 1;
+        player.jetpackOn = flags & 2;
+        newConnected[i] = flags & 4;
+    }
+    int width = reader.u32();
+    int height = reader.u32();
+    if (!reader.ok() || width != map.getWidth() || height != map.getHeight()) {
+        return false;
+    }
+    const uint8_t* cells = reader.bytes(static_cast<size_t>(width) * height);
+    if (!cells) {
+        return false;
+    }
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            map.setCell(x, y, static_cast<CellType>(cells[y * width + x]));
+        }
+    }
+    tick = newTick;
+    state = newState;
+    winnerId = newWinner;
+    players = newPlayers;
+    connected = newConnected;
+    return true;
+}
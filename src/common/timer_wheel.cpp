@@ -0,0 +1,173 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+
+TimerWheel::TimerWheel(int64_t nowMs)
+    : currentMs(nowMs) {
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            heads[level][slot] = NONE;
+        }
+    }
+}
+
+TimerWheel::Id TimerWheel::schedule(int64_t delayMs, std::function<void()> callback) {
+    const int64_t maxDelay = (int64_t(1) << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    uint32_t index;
+    if (freeList != NONE) {
+        index = freeList;
+        freeList = nodes[index].next;
+    } else {
+        index = nodes.size();
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    // Due at the earliest on the next millisecond advance() reaches.
+    node.expiresMs = currentMs + std::clamp<int64_t>(delayMs, 1, maxDelay);
+    node.generation++;
+    node.active = true;
+    node.callback = std::move(callback);
+    link(index);
+    count++;
+    return (Id(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(Id id) {
+    uint32_t index = id & 0xffffffffu;
+    if (id == 0 || index >= nodes.size()) {
+        return false;
+    }
+    Node& node = nodes[index];
+    if (!node.active || node.generation != (id >> 32)) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    return true;
+}
+
+// A timer goes to the lowest level whose span still reaches its expiry,
+// in the slot given by that level's digits of the expiry time.
+void TimerWheel::link(uint32_t index) {
+    Node& node = nodes[index];
+    int64_t delta = node.expiresMs - currentMs;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (int64_t(1) << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    int slot = (node.expiresMs >> (TIMER_WHEEL_SLOT_BITS * level)) & (SLOTS - 1);
+
+    node.level = level;
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = heads[level][slot];
+    if (node.next != NONE) {
+        nodes[node.next].prev = index;
+    }
+    heads[level][slot] = index;
+    occupied[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NONE) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.level][node.slot] = node.next;
+        if (node.next == NONE) {
+            occupied[node.level] &= ~(uint64_t(1) << node.slot);
+        }
+    }
+    if (node.next != NONE) {
+        nodes[node.next].prev = node.prev;
+    }
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.active = false;
+    node.callback = nullptr;
+    node.next = freeList;
+    freeList = index;
+    count--;
+}
+
+// Spreads the slot of this level that time has just entered over the
+// levels below.
+void TimerWheel::cascade(int level) {
+    int slot = (currentMs >> (TIMER_WHEEL_SLOT_BITS * level)) & (SLOTS - 1);
+    uint32_t index = heads[level][slot];
+    heads[level][slot] = NONE;
+    occupied[level] &= ~(uint64_t(1) << slot);
+    while (index != NONE) {
+        uint32_t next = nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+size_t TimerWheel::advance(int64_t nowMs) {
+    size_t fired = 0;
+
+    while (currentMs < nowMs) {
+        // Nothing pending below level 1: jump to the end of this 64 ms
+        // stretch instead of walking it.
+        if (occupied[0] == 0) {
+            int64_t stretchEnd = currentMs | (SLOTS - 1);
+            if (stretchEnd >= nowMs) {
+                currentMs = nowMs;
+                break;
+            }
+            currentMs = stretchEnd;
+        }
+
+        currentMs++;
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if ((currentMs & ((int64_t(1) << (TIMER_WHEEL_SLOT_BITS * level)) - 1)) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        int slot = currentMs & (SLOTS - 1);
+        while (heads[0][slot] != NONE) {
+            uint32_t index = heads[0][slot];
+            unlink(index);
+            std::function<void()> callback = std::move(nodes[index].callback);
+            release(index);
+            fired++;
+            callback();
+        }
+    }
+    return fired;
+}
+
+int TimerWheel::timeoutMs(int64_t nowMs, int maxMs) const {
+    if (count == 0) {
+        return maxMs;
+    }
+    // Level 0 knows its due times exactly. Anything higher up only comes
+    // down at a stretch boundary, possibly due early in the stretch after
+    // it, so the wait never goes past the next boundary while the higher
+    // levels hold timers.
+    int64_t boundary = (currentMs | (SLOTS - 1)) + 1;
+    bool higherOccupied = false;
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        higherOccupied = higherOccupied || occupied[level] != 0;
+    }
+    int64_t next = boundary;
+    if (occupied[0] != 0) {
+        for (int step = 1; step <= SLOTS; step++) {
+            int64_t candidate = currentMs + step;
+            if (occupied[0] & (uint64_t(1) << (candidate & (SLOTS - 1)))) {
+                next = higherOccupied ? std::min(candidate, boundary) : candidate;
+                break;
+            }
+        }
+    }
+    int64_t wait = next - nowMs;
+    if (wait <= 0) {
+        return 0;
+    }
+    return wait < maxMs ? (int)wait : maxMs;
+}
@@ -0,0 +1,276 @@
+#include "load.hpp"
+#include <sys/resource.h>
+#include <ctime>
+#include <iomanip>
+
+LoadGenerator::LoadGenerator(const LoadConfig& config)
+    : config(config) {
+}
+
+void LoadGenerator::resolveAddress() {
+    std::memset(&address, 0, sizeof(address));
+    if (!config.unixSocketPath.empty()) {
+        struct sockaddr_un* addr = (struct sockaddr_un*)&address;
+        addr->sun_family = AF_UNIX;
+        std::strncpy(addr->sun_path, config.unixSocketPath.c_str(), sizeof(addr->sun_path) - 1);
+        addressLength = sizeof(struct sockaddr_un);
+    } else {
+        struct sockaddr_in* addr = (struct sockaddr_in*)&address;
+        addr->sin_family = AF_INET;
+        addr->sin_port = htons(config.port);
+        inet_pton(AF_INET, config.serverIP.c_str(), &addr->sin_addr);
+        addressLength = sizeof(struct sockaddr_in);
+    }
+}
+
+Task<> LoadGenerator::play(int index) {
+    LoadConnection& conn = connections[index];
+
+    if (!co_await conn.session->connect((struct sockaddr*)&address, addressLength)) {
+        connectFailures++;
+        co_return;
+    }
+    conn.connected = true;
+
+    if (!co_await sendPacket(conn, READY, nullptr, 0)) {
+        readyFailures++;
+        co_return;
+    }
+    loop.spawn(sendInputs(index));
+    AsyncSession::Frame frame;
+    while (co_await conn.session->readFrame(frame)) {
+        handlePacket(conn, frame.type, frame.data, frame.length);
+        // Answered like a client would, so the server can measure us.
+        if (frame.type == PING && frame.length >= (int)Wire::PongLayout::SIZE &&
+            !co_await sendPacket(conn, PONG, frame.data, Wire::PongLayout::SIZE)) {
+            co_return;
+        }
+    }
+    // Only a read that found the session gone: hang-ups and resets.
+    closedByServer++;
+}
+
+Task<> LoadGenerator::sendInputs(int index) {
+    const std::chrono::microseconds TICK_DURATION(1000000 / 60);
+    LoadConnection& conn = connections[index];
+    auto nextTick = EventLoop::Clock::now() + TICK_DURATION;
+
+    while (conn.session->isOpen()) {
+        co_await loop.sleepUntil(nextTick);
+        auto now = EventLoop::Clock::now();
+        nextTick += TICK_DURATION;
+        if (nextTick < now) {
+            nextTick = now + TICK_DURATION;
+        }
+        if (!conn.gotMap || conn.playerId < 0) {
+            continue;
+        }
+
+        conn.rngState = conn.rngState * 1103515245u + 12345u;
+        if ((conn.rngState >> 16) % 30 == 0) {
+            conn.jetpackOn = !conn.jetpackOn;
+        }
+
+        using Layout = Wire::PlayerPositionLayout;
+        char data[Layout::SIZE];
+        Wire::Writer<Layout> position(data);
+        position.set<Layout::PlayerId>(conn.playerId);
+        position.set<Layout::X>(0.0f);
+        position.set<Layout::Y>(0.0f);
+        position.set<Layout::JetpackOn>(conn.jetpackOn ? 1 : 0);
+        if (!co_await sendPacket(conn, PLAYER_POS, data, sizeof(data))) {
+            break;
+        }
+    }
+}
+
+void LoadGenerator::handlePacket(LoadConnection& conn, int packetType, const char* data, int length) {
+    total.packetsIn++;
+    interval.packetsIn++;
+    total.bytesIn += Wire::HeaderLayout::SIZE + length;
+    interval.bytesIn += Wire::HeaderLayout::SIZE + length;
+
+    switch (packetType) {
+        case ASSIGN_PLAYER_ID:
+            if (length >= (int)Wire::IntLayout::SIZE) {
+                conn.playerId = Wire::View<Wire::IntLayout>(data).get<Wire::IntLayout::Value>();
+            }
+            break;
+        case MAP_DATA:
+            conn.gotMap = true;
+            break;
+        case GAME_STATE: {
+            auto now = std::chrono::steady_clock::now();
+            if (conn.hasSnapshot) {
+                uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(now - conn.lastSnapshot).count();
+                interArrival.record(micros);
+                intervalInterArrival.record(micros);
+            }
+            conn.hasSnapshot = true;
+            conn.lastSnapshot = now;
+            total.snapshots++;
+            interval.snapshots++;
+            break;
+        }
+        case GAME_OVER:
+            conn.hasSnapshot = false;
+            break;
+        default:
+            break;
+    }
+}
+
+Task<bool> LoadGenerator::sendPacket(LoadConnection& conn, int packetType, const void* data, int length) {
+    total.packetsOut++;
+    interval.packetsOut++;
+    total.bytesOut += Wire::HeaderLayout::SIZE + length;
+    interval.bytesOut += Wire::HeaderLayout::SIZE + length;
+    return conn.session->write(packetType, data, length);
+}
+
+int LoadGenerator::countConnected() const {
+    int count = 0;
+    for (const LoadConnection& conn : connections) {
+        if (conn.session && conn.session->isOpen() && conn.connected) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int LoadGenerator::countPlaying() const {
+    int count = 0;
+    for (const LoadConnection& conn : connections) {
+        if (conn.session && conn.session->isOpen() && conn.gotMap) {
+            count++;
+        }
+    }
+    return count;
+}
+
+long LoadGenerator::readServerCpuTicks() const {
+    if (config.serverPid <= 0) {
+        return -1;
+    }
+
+    std::ifstream file("/proc/" + std::to_string(config.serverPid) + "/stat");
+    std::string content;
+    if (!std::getline(file, content)) {
+        return -1;
+    }
+
+    size_t end = content.rfind(')');
+    if (end == std::string::npos) {
+        return -1;
+    }
+    std::istringstream stream(content.substr(end + 2));
+    std::string field;
+    long utime = 0;
+    long stime = 0;
+    for (int i = 3; i <= 15 && stream >> field; i++) {
+        if (i == 14) {
+            utime = std::atol(field.c_str());
+        } else if (i == 15) {
+            stime = std::atol(field.c_str());
+        }
+    }
+    return utime + stime;
+}
+
+// Printed next to the server's: on a shared machine, a generator that
+// spins (as a level-triggered EPOLLOUT once made it do) eats the server's
+// cores and skews its figures.
+double LoadGenerator::readOwnCpuSeconds() {
+    struct timespec usage;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &usage) < 0) {
+        return 0;
+    }
+    return usage.tv_sec + usage.tv_nsec / 1e9;
+}
+
+void LoadGenerator::report(const char* label, const Histogram& histogram, const LoadCounters& counters,
+    double seconds, long cpuTicks, double ownCpuSeconds) {
+    int connected = countConnected();
+    int playing = countPlaying();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "[" << label << "] " << connected << "/" << config.connections << " connectés, "
+              << playing << " en jeu, " << connectFailures << " échecs, " << readyFailures << " READY non envoyés, "
+              << closedByServer << " fermés par le serveur" << std::endl
+              << "  snapshots: " << counters.snapshots / seconds << "/s, intervalle p50="
+              << histogram.percentile(50.0) / 1000.0 << "ms p99=" << histogram.percentile(99.0) / 1000.0
+              << "ms p999=" << histogram.percentile(99.9) / 1000.0 << "ms max=" << histogram.max() / 1000.0 << "ms" << std::endl
+              << "  débit: in " << counters.packetsIn / seconds << " pkt/s " << counters.bytesIn / seconds / 1024.0
+              << " KiB/s, out " << counters.packetsOut / seconds << " pkt/s " << counters.bytesOut / seconds / 1024.0
+              << " KiB/s" << std::endl;
+
+    if (cpuTicks >= 0) {
+        double cpuPercent = 100.0 * cpuTicks / sysconf(_SC_CLK_TCK) / seconds;
+        std::cout << "  cpu serveur: " << cpuPercent << "%";
+        if (playing > 0) {
+            std::cout << ", " << cpuPercent / playing << "% par joueur connecté";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "  cpu générateur: " << 100.0 * ownCpuSeconds / seconds << "%" << std::endl;
+}
+
+Task<> LoadGenerator::reportIntervals() {
+    auto nextReport = intervalStart + std::chrono::seconds(config.reportSeconds);
+
+    while (true) {
+        co_await loop.sleepUntil(nextReport);
+        auto now = EventLoop::Clock::now();
+        long cpuTicks = readServerCpuTicks();
+        double ownCpuSeconds = readOwnCpuSeconds();
+        double seconds = std::chrono::duration<double>(now - intervalStart).count();
+        report("intervalle", intervalInterArrival, interval, seconds,
+            cpuTicks >= 0 && lastServerCpuTicks >= 0 ? cpuTicks - lastServerCpuTicks : -1,
+            ownCpuSeconds - lastOwnCpuSeconds);
+        lastServerCpuTicks = cpuTicks;
+        lastOwnCpuSeconds = ownCpuSeconds;
+        intervalInterArrival.reset();
+        interval = LoadCounters();
+        intervalStart = now;
+        nextReport += std::chrono::seconds(config.reportSeconds);
+    }
+}
+
+bool LoadGenerator::run() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    if (!loop.open()) {
+        return false;
+    }
+    resolveAddress();
+
+    connections.resize(config.connections);
+    for (int i = 0; i < config.connections; i++) {
+        connections[i].session = std::make_unique<AsyncSession>(loop);
+        connections[i].rngState = i * 2654435761u + 1;
+        loop.spawn(play(i));
+    }
+
+    auto startTime = EventLoop::Clock::now();
+    intervalStart = startTime;
+    startServerCpuTicks = readServerCpuTicks();
+    lastServerCpuTicks = startServerCpuTicks;
+    startOwnCpuSeconds = readOwnCpuSeconds();
+    lastOwnCpuSeconds = startOwnCpuSeconds;
+    loop.spawn(reportIntervals());
+
+    if (!loop.runUntil(startTime + std::chrono::seconds(config.durationSeconds))) {
+        return false;
+    }
+
+    long cpuTicks = readServerCpuTicks();
+    double seconds = std::chrono::duration<double>(EventLoop::Clock::now() - startTime).count();
+    report("total", interArrival, total, seconds,
+        cpuTicks >= 0 && startServerCpuTicks >= 0 ? cpuTicks - startServerCpuTicks : -1,
+        readOwnCpuSeconds() - startOwnCpuSeconds);
+    return true;
+}
@@ -0,0 +1,56 @@
+#include "load.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -h <ip> -p <port> | -u <path> [-n <count>] [-t <seconds>] [-i <seconds>] [-P <pid>] [-d]" << std::endl;
+    std::cout << "  -h <ip>       IP address of the server" << std::endl;
+    std::cout << "  -p <port>     Port of the server" << std::endl;
+    std::cout << "  -u <path>     Connect over a UNIX socket instead of TCP" << std::endl;
+    std::cout << "  -n <count>    Number of simulated players (default 100)" << std::endl;
+    std::cout << "  -t <seconds>  Duration of the run (default 30)" << std::endl;
+    std::cout << "  -i <seconds>  Interval between reports (default 5)" << std::endl;
+    std::cout << "  -P <pid>      Server process to sample CPU usage from" << std::endl;
+    std::cout << "  -d            Enable debug mode" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" && i + 1 < argc) {
+            config.serverIP = argv[++i];
+        } else if (arg == "-p" && i + 1 < argc) {
+            config.port = std::atoi(argv[++i]);
+        } else if (arg == "-u" && i + 1 < argc) {
+            config.unixSocketPath = argv[++i];
+        } else if (arg == "-n" && i + 1 < argc) {
+            config.connections = std::atoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            config.durationSeconds = std::atoi(argv[++i]);
+        } else if (arg == "-i" && i + 1 < argc) {
+            config.reportSeconds = std::atoi(argv[++i]);
+        } else if (arg == "-P" && i + 1 < argc) {
+            config.serverPid = std::atoi(argv[++i]);
+        } else if (arg == "-d") {
+            debug_mode = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((config.port <= 0 && config.unixSocketPath.empty()) || config.connections <= 0 ||
+        config.durationSeconds <= 0 || config.reportSeconds <= 0) {
+        std::cerr << "Missing required arguments!" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    LoadGenerator generator(config);
+    return generator.run() ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#include "asset_pack.hpp"
+#include <iostream>
+#include <string>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -o <pack> <file>..." << std::endl;
+    std::cout << "  -o <pack>  Asset pack to write; files are stored under their base name" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputFile;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-o" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (outputFile.empty() || files.empty()) {
+        std::cerr << "Missing required arguments!" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!AssetPack::write(outputFile, files)) {
+        return 1;
+    }
+    std::cout << files.size() << " fichiers écrits dans " << outputFile << std::endl;
+    return 0;
+}
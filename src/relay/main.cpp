@@ -0,0 +1,57 @@
+#include "relay.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -h <ip> -p <port> | -u <path> -l <port> [-n <count>] [-i <seconds>] [-d]" << std::endl;
+    std::cout << "  -h <ip>       IP address of the upstream server or relay" << std::endl;
+    std::cout << "  -p <port>     Port of the upstream server or relay" << std::endl;
+    std::cout << "  -u <path>     Connect upstream over a UNIX socket instead of TCP" << std::endl;
+    std::cout << "  -l <port>     Port on which spectators connect to this relay" << std::endl;
+    std::cout << "  -n <count>    Maximum number of spectators (default " << RELAY_MAX_SPECTATORS << ")" << std::endl;
+    std::cout << "  -i <seconds>  Print fan-out statistics at this interval" << std::endl;
+    std::cout << "  -d            Enable debug mode" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    RelayConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" && i + 1 < argc) {
+            config.upstreamIP = argv[++i];
+        } else if (arg == "-p" && i + 1 < argc) {
+            config.upstreamPort = std::atoi(argv[++i]);
+        } else if (arg == "-u" && i + 1 < argc) {
+            config.upstreamUnixPath = argv[++i];
+        } else if (arg == "-l" && i + 1 < argc) {
+            config.listenPort = std::atoi(argv[++i]);
+        } else if (arg == "-n" && i + 1 < argc) {
+            config.maxSpectators = std::atoi(argv[++i]);
+        } else if (arg == "-i" && i + 1 < argc) {
+            config.reportSeconds = std::atoi(argv[++i]);
+        } else if (arg == "-d") {
+            debug_mode = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((config.upstreamPort <= 0 && config.upstreamUnixPath.empty()) || config.listenPort <= 0 ||
+        config.maxSpectators <= 0 || config.reportSeconds < 0) {
+        std::cerr << "Missing required arguments!" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Relay relay(config);
+    if (!relay.start()) {
+        std::cerr << "Failed to start relay" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include "relay.hpp"
+#include <algorithm>
+#include <chrono>
+
+Relay::Relay(const RelayConfig& config)
+    : config(config), spectators(config.maxSpectators, MAX_SPECTATOR_BACKLOG, stats) {
+}
+
+Relay::~Relay() {
+    stop();
+}
+
+bool Relay::start() {
+    if (!connectUpstream()) {
+        return false;
+    }
+    if (!openListenSocket()) {
+        close(upstreamSocket);
+        upstreamSocket = -1;
+        return false;
+    }
+    std::cout << "Relais démarré sur le port " << config.listenPort << std::endl;
+
+    running = true;
+    upstreamThread = std::thread(&Relay::upstreamLoop, this);
+    handleConnections();
+    stop();
+    return true;
+}
+
+void Relay::stop() {
+    running = false;
+    if (upstreamSocket >= 0) {
+        shutdown(upstreamSocket, SHUT_RDWR);
+    }
+    if (upstreamThread.joinable()) {
+        upstreamThread.join();
+    }
+    if (upstreamSocket >= 0) {
+        close(upstreamSocket);
+        upstreamSocket = -1;
+    }
+    for (const PendingClient& client : pendingClients) {
+        close(client.socket);
+    }
+    pendingClients.clear();
+    spectators.closeAll();
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+}
+
+bool Relay::connectUpstream() {
+    bool useUnix = !config.upstreamUnixPath.empty();
+
+    upstreamSocket = socket(useUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (upstreamSocket < 0) {
+        std::cerr << "Erreur lors de la création du socket" << std::endl;
+        return false;
+    }
+
+    int result;
+    if (useUnix) {
+        struct sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, config.upstreamUnixPath.c_str(), sizeof(addr.sun_path) - 1);
+        result = ::connect(upstreamSocket, (struct sockaddr*)&addr, sizeof(addr));
+    } else {
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.upstreamPort);
+        if (inet_pton(AF_INET, config.upstreamIP.c_str(), &addr.sin_addr) <= 0) {
+            std::cerr << "Adresse IP invalide: " << config.upstreamIP << std::endl;
+            close(upstreamSocket);
+            upstreamSocket = -1;
+            return false;
+        }
+        result = ::connect(upstreamSocket, (struct sockaddr*)&addr, sizeof(addr));
+    }
+
+    if (result < 0 || !Protocol::sendPacket(upstreamSocket, SPECTATE)) {
+        std::cerr << "Erreur lors de la connexion à la source: " << strerror(errno) << std::endl;
+        close(upstreamSocket);
+        upstreamSocket = -1;
+        return false;
+    }
+    std::cout << "Connecté à la source en tant que spectateur" << std::endl;
+    return true;
+}
+
+bool Relay::openListenSocket() {
+    // Non-blocking so a wakeup can drain every queued connection.
+    listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenSocket < 0) {
+        std::cerr << "Erreur lors de la création du socket" << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        std::cerr << "Erreur lors de la configuration du socket" << std::endl;
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(config.listenPort);
+
+    if (bind(listenSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenSocket, SOMAXCONN) < 0) {
+        std::cerr << "Erreur lors de l'écoute sur le port " << config.listenPort << std::endl;
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    return true;
+}
+
+void Relay::upstreamLoop() {
+    char buffer[MAX_BUFFER_SIZE];
+    int packetType;
+
+    while (running) {
+        int dataSize = Protocol::receivePacket(upstreamSocket, packetType, buffer, MAX_BUFFER_SIZE,
+            &upstreamTraffic);
+        if (dataSize < 0) {
+            std::cout << "Source déconnectée, arrêt du relais" << std::endl;
+            break;
+        }
+        forward(packetType, buffer, dataSize);
+    }
+    running = false;
+}
+
+void Relay::forward(int packetType, const char* data, int dataLength) {
+    feed.publish(packetType, Protocol::encodePacket(packetType, data, dataLength));
+}
+
+void Relay::handleConnections() {
+    std::vector<pollfd> fds;
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(config.reportSeconds);
+
+    while (running) {
+        // Only here, with no descriptor from the last poll still in use,
+        // may spectators the upstream thread dropped be closed.
+        spectators.closeRetired();
+        expirePendingClients();
+        fds.clear();
+        fds.push_back({listenSocket, POLLIN, 0});
+        for (const PendingClient& client : pendingClients) {
+            fds.push_back({client.socket, POLLIN, 0});
+        }
+        size_t firstSpectator = fds.size();
+        spectators.appendPollFds(fds);
+
+        int ready = poll(fds.data(), fds.size(), POLL_TIMEOUT);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "Erreur de poll: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        if (config.reportSeconds > 0 && std::chrono::steady_clock::now() >= nextReport) {
+            report();
+            nextReport += std::chrono::seconds(config.reportSeconds);
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        // Pending clients are still in poll order: one that is done with
+        // is only marked, and they are compacted afterwards.
+        for (size_t i = 1; i < firstSpectator; i++) {
+            PendingClient& client = pendingClients[i - 1];
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && handlePendingMessage(client)) {
+                client.socket = -1;
+            }
+        }
+        pendingClients.erase(std::remove_if(pendingClients.begin(), pendingClients.end(),
+            [](const PendingClient& client) { return client.socket < 0; }), pendingClients.end());
+        for (size_t i = firstSpectator; i < fds.size(); i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                handleSpectatorMessage(fds[i].fd);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+    }
+}
+
+// Drains the whole accept queue, so a burst of connections does not wait
+// behind the relay traffic one loop turn each. Clients are non-blocking
+// from the start: one that connects and sends nothing, or half a header,
+// must not hold up the relay.
+void Relay::acceptClients() {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RELAY_HANDSHAKE_TIMEOUT_MS);
+    while (true) {
+        int clientSocket = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSocket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Erreur lors de l'acceptation de la connexion: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        PendingClient client;
+        client.socket = clientSocket;
+        client.deadline = deadline;
+        pendingClients.push_back(client);
+    }
+}
+
+// Reads what has arrived of the first header; true once the client is
+// done with, joined or closed. Only the type matters: a payload, and
+// anything sent after it, is read and discarded like any spectator's.
+bool Relay::handlePendingMessage(PendingClient& client) {
+    ssize_t received = recv(client.socket, client.header + client.received,
+        sizeof(client.header) - client.received, MSG_DONTWAIT);
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return false;
+    }
+    if (received <= 0) {
+        close(client.socket);
+        return true;
+    }
+    client.received += received;
+    if (client.received < sizeof(client.header)) {
+        return false;
+    }
+
+    PacketHeader header;
+    if (!Protocol::readHeader(client.header, header)) {
+        close(client.socket);
+        return true;
+    }
+    // A relay has no player slots: READY is answered like SPECTATE.
+    if (header.type != READY && header.type != SPECTATE) {
+        LOG_WARN("Premier paquet inattendu: " << header.type);
+        close(client.socket);
+        return true;
+    }
+    feed.join(client.socket);
+    return true;
+}
+
+void Relay::expirePendingClients() {
+    auto now = std::chrono::steady_clock::now();
+    size_t kept = 0;
+    for (size_t i = 0; i < pendingClients.size(); i++) {
+        if (pendingClients[i].deadline <= now) {
+            LOG_DEBUG("Aucun paquet d'ouverture reçu, fermeture du socket " << pendingClients[i].socket);
+            close(pendingClients[i].socket);
+            continue;
+        }
+        if (kept != i) {
+            pendingClients[kept] = pendingClients[i];
+        }
+        kept++;
+    }
+    pendingClients.resize(kept);
+}
+
+void Relay::handleSpectatorMessage(int clientSocket) {
+    char buffer[MAX_BUFFER_SIZE];
+    ssize_t received = recv(clientSocket, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (received > 0 || (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))) {
+        return;
+    }
+    spectators.remove(clientSocket);
+}
+
+void Relay::report() {
+    std::cout << "spectateurs: " << stats.connected.load(std::memory_order_relaxed)
+              << ", reçus: " << upstreamTraffic.packetsReceived.load(std::memory_order_relaxed)
+              << " paquets, envoyés: " << stats.traffic.packetsSent.load(std::memory_order_relaxed)
+              << " paquets (" << stats.traffic.bytesSent.load(std::memory_order_relaxed) << " octets)"
+              << ", abandonnés: " << stats.dropped.load(std::memory_order_relaxed) << std::endl;
+}
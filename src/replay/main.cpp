@@ -0,0 +1,46 @@
+#include "playback.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " -r <file> [-s <tick>] [-x <speed>] [-e <ticks>] [-d]" << std::endl;
+    std::cout << "  -r <file>   Replay file recorded by the server with -R" << std::endl;
+    std::cout << "  -s <tick>   Seek to this tick through the keyframe index before playing" << std::endl;
+    std::cout << "  -x <speed>  Play at this multiple of real time (default: as fast as possible)" << std::endl;
+    std::cout << "  -e <ticks>  Print the players every <ticks> ticks" << std::endl;
+    std::cout << "  -d          Enable debug mode" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    PlaybackConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-r" && i + 1 < argc) {
+            config.replayFile = argv[++i];
+        } else if (arg == "-s" && i + 1 < argc) {
+            config.seekTick = std::atoi(argv[++i]);
+        } else if (arg == "-x" && i + 1 < argc) {
+            config.speed = std::atof(argv[++i]);
+        } else if (arg == "-e" && i + 1 < argc) {
+            config.printEvery = std::atoi(argv[++i]);
+        } else if (arg == "-d") {
+            debug_mode = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.replayFile.empty() || config.seekTick < 0 || config.speed < 0.0 || config.printEvery < 0) {
+        std::cerr << "Missing required arguments!" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Playback playback(config);
+    return playback.run() ? 0 : 1;
+}
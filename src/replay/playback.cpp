@@ -0,0 +1,133 @@
+#include "playback.hpp"
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+Playback::Playback(const PlaybackConfig& config)
+    : config(config) {
+}
+
+bool Playback::run() {
+    if (!reader.open(config.replayFile)) {
+        return false;
+    }
+    std::cout << "Replay " << config.replayFile << ": carte " << reader.getMap().getWidth() << "x"
+              << reader.getMap().getHeight() << ", seed " << reader.getSeed() << ", "
+              << reader.getIndex().size() << " keyframes" << (reader.hasIndex() ? "" : " (index reconstruit)")
+              << std::endl;
+
+    size_t cursor = reader.firstRecord();
+    simulation.start(reader.getMap(), reader.getSeed());
+    if (config.seekTick > 0) {
+        auto seekStart = std::chrono::steady_clock::now();
+        if (!reader.seek(simulation, config.seekTick, cursor)) {
+            std::cerr << "Keyframe illisible avant le tick " << config.seekTick << std::endl;
+            return false;
+        }
+        int keyframeTick = simulation.getTick();
+        ReplayRecord record;
+        size_t lookahead = cursor;
+        while (simulation.getTick() < config.seekTick && reader.next(lookahead, record) &&
+               record.type != Replay::RECORD_END && record.tick <= static_cast<uint32_t>(config.seekTick)) {
+            advanceTo(record.tick);
+            if (record.type == Replay::RECORD_INPUT) {
+                applyInput(record);
+            }
+            cursor = lookahead;
+        }
+        advanceTo(config.seekTick);
+        double seekMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - seekStart).count();
+        std::cout << "Positionné au tick " << simulation.getTick() << " depuis la keyframe du tick "
+                  << keyframeTick << " en " << std::fixed << std::setprecision(3) << seekMs << " ms"
+                  << std::endl;
+        printState();
+    }
+
+    ticksSimulated = 0;
+    startTime = std::chrono::steady_clock::now();
+    ReplayRecord record;
+    bool ended = false;
+    while (reader.next(cursor, record)) {
+        advanceTo(record.tick);
+        switch (record.type) {
+            case Replay::RECORD_INPUT:
+                applyInput(record);
+                break;
+            case Replay::RECORD_KEYFRAME:
+                checkKeyframe(record);
+                break;
+            case Replay::RECORD_END:
+                checkEnd(record);
+                ended = true;
+                break;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << ticksSimulated << " ticks rejoués en " << std::fixed << std::setprecision(3) << seconds
+              << " s (" << std::setprecision(0) << (seconds > 0 ? ticksSimulated / seconds : 0.0)
+              << " ticks/s), " << keyframesChecked << " keyframes vérifiées" << std::endl;
+    if (!ended) {
+        std::cout << "Replay interrompu au tick " << simulation.getTick() << " (pas de fin enregistrée)" << std::endl;
+    }
+    if (divergences > 0) {
+        std::cerr << divergences << " divergence(s) détectée(s)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Playback::advanceTo(uint32_t tick) {
+    while (simulation.getState() == RUNNING && static_cast<uint32_t>(simulation.getTick()) < tick) {
+        simulation.step();
+        ticksSimulated++;
+        if (config.printEvery > 0 && simulation.getTick() % config.printEvery == 0) {
+            printState();
+        }
+        if (config.speed > 0.0) {
+            auto target = startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(ticksSimulated / (Simulation::TICKS_PER_SECOND * config.speed)));
+            std::this_thread::sleep_until(target);
+        }
+    }
+}
+
+void Playback::applyInput(const ReplayRecord& record) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (simulation.isConnected(i) && !(record.connectedMask & (1u << i))) {
+            simulation.disconnectPlayer(i);
+        }
+        simulation.setJetpack(i, (record.jetpackMask & (1u << i)) != 0);
+    }
+}
+
+void Playback::checkKeyframe(const ReplayRecord& record) {
+    std::vector<uint8_t> state;
+    simulation.serialize(state);
+    keyframesChecked++;
+    if (static_cast<uint32_t>(simulation.getTick()) != record.tick || state.size() != record.stateSize ||
+        std::memcmp(state.data(), record.state, state.size()) != 0) {
+        std::cerr << "Divergence à la keyframe du tick " << record.tick << std::endl;
+        divergences++;
+    }
+}
+
+void Playback::checkEnd(const ReplayRecord& record) {
+    std::cout << "Fin au tick " << simulation.getTick() << ", gagnant: Joueur " << simulation.getWinnerId() << std::endl;
+    if (simulation.getState() != OVER || static_cast<uint32_t>(simulation.getTick()) != record.tick ||
+        simulation.getWinnerId() != record.winnerId) {
+        std::cerr << "Fin divergente: enregistré tick " << record.tick << ", gagnant " << record.winnerId << std::endl;
+        divergences++;
+    }
+}
+
+void Playback::printState() const {
+    std::cout << "tick " << simulation.getTick();
+    for (const Player& player : simulation.getPlayers()) {
+        std::cout << " | J" << player.id << " x=" << std::fixed << std::setprecision(1) << player.position.x
+                  << " y=" << player.position.y << " score=" << player.score
+                  << (player.alive ? "" : " mort") << (player.jetpackOn ? " jetpack" : "");
+    }
+    std::cout << std::endl;
+}
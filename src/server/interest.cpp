@@ -0,0 +1,34 @@
+#include "interest.hpp"
+#include <algorithm>
+
+void InterestGrid::build(const std::array<Player, MAX_PLAYERS>& players) {
+    cells.clear();
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        cells.emplace_back(columnOf(players[i].position.x), i);
+    }
+    std::sort(cells.begin(), cells.end());
+}
+
+void InterestGrid::select(int column, uint32_t snapshot, std::vector<int>& visible) const {
+    visible.clear();
+    auto nearBegin = std::lower_bound(cells.begin(), cells.end(),
+        std::make_pair(column - INTEREST_NEAR_COLUMNS, -1));
+    auto nearEnd = std::lower_bound(nearBegin, cells.end(),
+        std::make_pair(column + INTEREST_NEAR_COLUMNS + 1, -1));
+
+    for (auto it = nearBegin; it != nearEnd; ++it) {
+        visible.push_back(it->second);
+    }
+    // Distant players are spread over the interval by index, so their
+    // updates do not all land in the same snapshot.
+    for (auto it = cells.begin(); it != nearBegin; ++it) {
+        if ((snapshot + it->second) % INTEREST_DISTANT_TICKS == 0) {
+            visible.push_back(it->second);
+        }
+    }
+    for (auto it = nearEnd; it != cells.end(); ++it) {
+        if ((snapshot + it->second) % INTEREST_DISTANT_TICKS == 0) {
+            visible.push_back(it->second);
+        }
+    }
+}
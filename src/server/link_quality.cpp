@@ -0,0 +1,28 @@
+#include "link_quality.hpp"
+#include <cstdlib>
+
+void LinkQuality::addSample(int64_t rttUs) {
+    if (!isMeasured()) {
+        srttUs = rttUs;
+        jitterUs = 0;
+    } else {
+        srttUs += (rttUs - srttUs) / 8;
+        jitterUs += (std::llabs(rttUs - lastSampleUs) - jitterUs) / 16;
+    }
+    lastSampleUs = rttUs;
+}
+
+// Until a PONG came back only the send queue counts.
+void LinkQuality::adapt(int64_t queuedBytes) {
+    bool congested = queuedBytes > SEND_QUEUE_DEGRADE_BYTES || (isMeasured() && srttUs > RTT_DEGRADE_US);
+    bool clear = queuedBytes < SEND_QUEUE_RECOVER_BYTES && (!isMeasured() || srttUs < RTT_RECOVER_US);
+
+    if (congested && snapshotInterval < MAX_SNAPSHOT_INTERVAL) {
+        snapshotInterval++;
+        LOG_DEBUG("Lien dégradé (rtt " << srttUs << " us, file " << queuedBytes
+                  << " octets): un snapshot tous les " << snapshotInterval << " ticks");
+    } else if (clear && snapshotInterval > 1) {
+        snapshotInterval--;
+        LOG_DEBUG("Lien rétabli: un snapshot tous les " << snapshotInterval << " ticks");
+    }
+}
@@ -1,18 +1,46 @@
 #include "server.hpp"
+#include <cerrno>
+#include <csignal>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 
+namespace {
+    Server* stoppableServer = nullptr;
+
+    void requestStop(int) {
+        int savedErrno = errno;
+        stoppableServer->requestStop();
+        errno = savedErrno;
+    }
+}
+
 void printUsage(const char* binaryName) {
-    std::cout << "Usage: " << binaryName << " -p <port> -m <map> [-d]" << std::endl;
+    std::cout << "Usage: " << binaryName << " -p <port> | -u <path> -m <map> [-M <port>] [-R <file>] [-w <count>] [-c] [-b <backlog>] [-a <count>] [-i <backend>] [-d]" << std::endl;
     std::cout << "  -p <port>  Port on which the server will listen" << std::endl;
+    std::cout << "  -u <path>  Listen on a UNIX socket instead of TCP" << std::endl;
     std::cout << "  -m <map>   Path to the map file" << std::endl;
+    std::cout << "  -M <port>  Serve Prometheus metrics on 127.0.0.1:<port>" << std::endl;
+    std::cout << "  -R <file>  Record the match to a replay file" << std::endl;
+    std::cout << "  -w <count> Number of room worker threads (default 0: one per core)" << std::endl;
+    std::cout << "  -c         Pin each room worker to its own core" << std::endl;
+    std::cout << "  -b <n>     Listen backlog (default " << DEFAULT_LISTEN_BACKLOG << ")" << std::endl;
+    std::cout << "  -a <count> Accept on <count> SO_REUSEPORT listener threads (TCP only)" << std::endl;
+    std::cout << "  -i <name>  I/O backend: poll or uring (default " << DEFAULT_NET_BACKEND << ")" << std::endl;
     std::cout << "  -d         Enable debug mode" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     int port = 0;
     std::string mapFile;
+    std::string unixSocketPath;
+    int metricsPort = 0;
+    std::string replayFile;
+    int roomWorkers = DEFAULT_ROOM_WORKERS;
+    bool pinRoomWorkers = false;
+    int listenBacklog = DEFAULT_LISTEN_BACKLOG;
+    int listenerThreads = 0;
+    std::string netBackend = DEFAULT_NET_BACKEND;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -21,6 +49,22 @@ int main(int argc, char* argv[]) {
             port = std::atoi(argv[++i]);
         } else if (arg == "-m" && i + 1 < argc) {
             mapFile = argv[++i];
+        } else if (arg == "-u" && i + 1 < argc) {
+            unixSocketPath = argv[++i];
+        } else if (arg == "-M" && i + 1 < argc) {
+            metricsPort = std::atoi(argv[++i]);
+        } else if (arg == "-R" && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (arg == "-w" && i + 1 < argc) {
+            roomWorkers = std::atoi(argv[++i]);
+        } else if (arg == "-c") {
+            pinRoomWorkers = true;
+        } else if (arg == "-b" && i + 1 < argc) {
+            listenBacklog = std::atoi(argv[++i]);
+        } else if (arg == "-a" && i + 1 < argc) {
+            listenerThreads = std::atoi(argv[++i]);
+        } else if (arg == "-i" && i + 1 < argc) {
+            netBackend = argv[++i];
         } else if (arg == "-d") {
             debug_mode = true;
         } else {
@@ -30,21 +74,52 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    if (port <= 0 || mapFile.empty()) {
+    if ((port <= 0 && unixSocketPath.empty()) || mapFile.empty() || roomWorkers < 0 ||
+        listenBacklog <= 0 || listenerThreads < 0) {
         std::cerr << "Missing required arguments!" << std::endl;
         printUsage(argv[0]);
         return 1;
     }
     
+    if (netBackend != "poll" && netBackend != "uring") {
+        std::cerr << "Unknown I/O backend: " << netBackend << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (listenerThreads > 0 && !unixSocketPath.empty()) {
+        std::cerr << "Listener threads need a TCP port" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    
     Server server(port, mapFile);
+    server.setUnixSocketPath(unixSocketPath);
+    server.setMetricsPort(metricsPort);
+    server.setReplayFile(replayFile);
+    server.setRoomWorkers(roomWorkers);
+    server.setPinRoomWorkers(pinRoomWorkers);
+    server.setListenBacklog(listenBacklog);
+    server.setListenerThreads(listenerThreads);
+    server.setNetBackend(netBackend);
     
+    // start() keeps this thread until one of these asks the lobby to stop.
+    stoppableServer = &server;
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::cout << "Press Enter to stop the server..." << std::endl;
+    std::thread([&server]() {
+        if (std::cin.get() != EOF) {
+            server.requestStop();
+        }
+    }).detach();
+
     if (!server.start()) {
         std::cerr << "Failed to start server" << std::endl;
         return 1;
     }
-    
-    std::cout << "Press Enter to stop the server..." << std::endl;
-    std::cin.get();
     server.stop();
     return 0;
 }
\ No newline at end of file
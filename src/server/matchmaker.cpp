@@ -0,0 +1,106 @@
+#include "matchmaker.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+Matchmaker::BucketKey Matchmaker::bucketOf(const QueueEntry& entry) {
+    int skill = std::max(entry.skillRating, 0) / SKILL_BUCKET_WIDTH;
+    int latency = std::min(std::max(entry.latencyMs, 0) / LATENCY_BUCKET_MS, LATENCY_BUCKET_COUNT - 1);
+    return {skill, latency};
+}
+
+void Matchmaker::enqueue(const QueueEntry& entry) {
+    BucketKey key = bucketOf(entry);
+    buckets[key].push_back(entry);
+    index[entry.socket] = key;
+}
+
+bool Matchmaker::remove(int socket) {
+    auto found = index.find(socket);
+    if (found == index.end()) {
+        return false;
+    }
+    auto bucket = buckets.find(found->second);
+    std::deque<QueueEntry>& queue = bucket->second;
+    queue.erase(std::find_if(queue.begin(), queue.end(),
+        [socket](const QueueEntry& entry) { return entry.socket == socket; }));
+    if (queue.empty()) {
+        buckets.erase(bucket);
+    }
+    index.erase(found);
+    return true;
+}
+
+void Matchmaker::closeAll() {
+    for (const auto& entry : index) {
+        close(entry.first);
+    }
+    buckets.clear();
+    index.clear();
+}
+
+void Matchmaker::formMatches(int64_t nowNs, std::vector<MatchGroup>& matches) {
+    matches.clear();
+
+    // A bucket holding a full group starts it right away, oldest first.
+    for (auto it = buckets.begin(); it != buckets.end();) {
+        std::deque<QueueEntry>& queue = it->second;
+        while (queue.size() >= MAX_PLAYERS) {
+            MatchGroup match;
+            for (int i = 0; i < MAX_PLAYERS; i++) {
+                match[i] = queue.front();
+                index.erase(queue.front().socket);
+                queue.pop_front();
+            }
+            matches.push_back(match);
+        }
+        it = queue.empty() ? buckets.erase(it) : std::next(it);
+    }
+
+    // What is left is fewer than MAX_PLAYERS per bucket. Starting from the
+    // longest wait, let each player widen its search as its wait grows.
+    std::vector<QueueEntry> oldest;
+    for (const auto& bucket : buckets) {
+        oldest.push_back(bucket.second.front());
+    }
+    std::sort(oldest.begin(), oldest.end(),
+        [](const QueueEntry& a, const QueueEntry& b) { return a.enqueuedNs < b.enqueuedNs; });
+
+    for (const QueueEntry& entry : oldest) {
+        if (!contains(entry.socket)) {
+            continue;
+        }
+        MatchGroup match;
+        if (formWidened(entry, nowNs, match)) {
+            matches.push_back(match);
+        } else if ((nowNs - entry.enqueuedNs) / (MATCH_WIDEN_SECONDS * 1000000000LL) == 0) {
+            break;
+        }
+    }
+}
+
+bool Matchmaker::formWidened(const QueueEntry& oldest, int64_t nowNs, MatchGroup& match) {
+    int tolerance = static_cast<int>((nowNs - oldest.enqueuedNs) / (MATCH_WIDEN_SECONDS * 1000000000LL));
+    if (tolerance == 0) {
+        return false;
+    }
+    BucketKey home = bucketOf(oldest);
+
+    std::vector<QueueEntry> candidates;
+    for (const auto& bucket : buckets) {
+        if (std::abs(bucket.first.first - home.first) <= tolerance &&
+            std::abs(bucket.first.second - home.second) <= tolerance) {
+            candidates.insert(candidates.end(), bucket.second.begin(), bucket.second.end());
+        }
+    }
+    if (candidates.size() < MAX_PLAYERS) {
+        return false;
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [](const QueueEntry& a, const QueueEntry& b) { return a.enqueuedNs < b.enqueuedNs; });
+
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        match[i] = candidates[i];
+        remove(candidates[i].socket);
+    }
+    return true;
+}
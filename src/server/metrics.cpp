@@ -0,0 +1,194 @@
+#include "metrics.hpp"
+#include <iomanip>
+
+void DurationHistogram::write(std::ostream& out, const std::string& name, const std::string& labels) const {
+    uint64_t cumulative = 0;
+    std::string prefix = labels.empty() ? "" : labels + ",";
+
+    for (int i = 0; i < BOUND_COUNT; i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        out << name << "_bucket{" << prefix << "le=\"" << bounds[i] / 1e9 << "\"} " << cumulative << "\n";
+    }
+    cumulative += buckets[BOUND_COUNT].load(std::memory_order_relaxed);
+    out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << "\n";
+    out << name << "_sum{" << labels << "} " << sumNs.load(std::memory_order_relaxed) / 1e9 << "\n";
+    out << name << "_count{" << labels << "} " << count.load(std::memory_order_relaxed) << "\n";
+}
+
+std::string ServerMetrics::render() const {
+    std::ostringstream out;
+    out << std::setprecision(9);
+
+    out << "# HELP jetpack_tick_phase_seconds Time spent in each phase of a game tick.\n"
+        << "# TYPE jetpack_tick_phase_seconds histogram\n";
+    tickUpdate.write(out, "jetpack_tick_phase_seconds", "phase=\"update\"");
+    tickCollisions.write(out, "jetpack_tick_phase_seconds", "phase=\"collisions\"");
+    tickBroadcast.write(out, "jetpack_tick_phase_seconds", "phase=\"broadcast\"");
+    tickTotal.write(out, "jetpack_tick_phase_seconds", "phase=\"total\"");
+
+    out << "# HELP jetpack_ticks_total Game ticks simulated.\n"
+        << "# TYPE jetpack_ticks_total counter\n"
+        << "jetpack_ticks_total " << ticks.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_ticks_stolen_total Room ticks run by a worker that stole them from another one.\n"
+        << "# TYPE jetpack_ticks_stolen_total counter\n"
+        << "jetpack_ticks_stolen_total " << ticksStolen.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_ticks_skipped_total Room ticks skipped because their worker reached the room a whole tick late.\n"
+        << "# TYPE jetpack_ticks_skipped_total counter\n"
+        << "jetpack_ticks_skipped_total " << ticksSkipped.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_room_commands_dropped_total Player inputs and pongs dropped because their room's queue was full.\n"
+        << "# TYPE jetpack_room_commands_dropped_total counter\n"
+        << "jetpack_room_commands_dropped_total " << commandsDropped.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_matches_started_total Matches started.\n"
+        << "# TYPE jetpack_matches_started_total counter\n"
+        << "jetpack_matches_started_total " << matchesStarted.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_matches_finished_total Matches that reached game over.\n"
+        << "# TYPE jetpack_matches_finished_total counter\n"
+        << "jetpack_matches_finished_total " << matchesFinished.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_connections_accepted_total Connections accepted, as a player or a spectator.\n"
+        << "# TYPE jetpack_connections_accepted_total counter\n"
+        << "jetpack_connections_accepted_total " << connectionsAccepted.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_connections_rejected_total Connections closed because every spectator slot was taken.\n"
+        << "# TYPE jetpack_connections_rejected_total counter\n"
+        << "jetpack_connections_rejected_total " << connectionsRejected.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_connected_clients Players currently in a match.\n"
+        << "# TYPE jetpack_connected_clients gauge\n"
+        << "jetpack_connected_clients " << connectedClients.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_queue_depth Players waiting in the matchmaking queue.\n"
+        << "# TYPE jetpack_queue_depth gauge\n"
+        << "jetpack_queue_depth " << queueDepth.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_rooms_active Matches currently being played.\n"
+        << "# TYPE jetpack_rooms_active gauge\n"
+        << "jetpack_rooms_active " << roomsActive.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_time_to_match_seconds Time a player spent in the queue before joining a match.\n"
+        << "# TYPE jetpack_time_to_match_seconds histogram\n";
+    timeToMatch.write(out, "jetpack_time_to_match_seconds", "");
+    out << "# HELP jetpack_client_rtt_seconds Round-trip time of each ping answered by a player.\n"
+        << "# TYPE jetpack_client_rtt_seconds histogram\n";
+    clientRtt.write(out, "jetpack_client_rtt_seconds", "");
+    out << "# HELP jetpack_snapshots_skipped_total Snapshots held back from players on a reduced rate.\n"
+        << "# TYPE jetpack_snapshots_skipped_total counter\n"
+        << "jetpack_snapshots_skipped_total " << snapshotsSkipped.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_connected_spectators Spectators currently watching.\n"
+        << "# TYPE jetpack_connected_spectators gauge\n"
+        << "jetpack_connected_spectators " << spectators.connected.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_spectators_dropped_total Spectators disconnected for falling too far behind.\n"
+        << "# TYPE jetpack_spectators_dropped_total counter\n"
+        << "jetpack_spectators_dropped_total " << spectators.dropped.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_spectator_packets_sent_total Packets delivered to spectators.\n"
+        << "# TYPE jetpack_spectator_packets_sent_total counter\n"
+        << "jetpack_spectator_packets_sent_total " << spectators.traffic.packetsSent.load(std::memory_order_relaxed) << "\n";
+    out << "# HELP jetpack_spectator_bytes_sent_total Bytes delivered to spectators.\n"
+        << "# TYPE jetpack_spectator_bytes_sent_total counter\n"
+        << "jetpack_spectator_bytes_sent_total " << spectators.traffic.bytesSent.load(std::memory_order_relaxed) << "\n";
+
+    const char* names[4] = {"packets_sent", "bytes_sent", "packets_received", "bytes_received"};
+    const char* help[4] = {
+        "Packets sent to the player in each slot, summed over every room.",
+        "Bytes sent to the player in each slot, summed over every room.",
+        "Packets received from the player in each slot, summed over every room.",
+        "Bytes received from the player in each slot, summed over every room."
+    };
+    for (int metric = 0; metric < 4; metric++) {
+        out << "# HELP jetpack_slot_" << names[metric] << "_total " << help[metric] << "\n"
+            << "# TYPE jetpack_slot_" << names[metric] << "_total counter\n";
+        for (int slot = 0; slot < MAX_PLAYERS; slot++) {
+            const TrafficCounters& counters = slotTraffic[slot];
+            const std::atomic<uint64_t>* values[4] = {
+                &counters.packetsSent, &counters.bytesSent, &counters.packetsReceived, &counters.bytesReceived
+            };
+            out << "jetpack_slot_" << names[metric] << "_total{slot=\"" << slot << "\"} "
+                << values[metric]->load(std::memory_order_relaxed) << "\n";
+        }
+    }
+    return out.str();
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+bool MetricsEndpoint::start(int port) {
+    listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenSocket < 0) {
+        std::cerr << "Erreur lors de la création du socket de métriques" << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (bind(listenSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listenSocket, 16) < 0) {
+        std::cerr << "Impossible d'ouvrir le point de métriques sur le port " << port << std::endl;
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+
+    running = true;
+    thread = std::thread(&MetricsEndpoint::serve, this);
+    std::cout << "Métriques disponibles sur http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+    }
+}
+
+void MetricsEndpoint::serve() {
+    while (running) {
+        struct pollfd pfd = {listenSocket, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+
+        int clientSocket = accept(listenSocket, nullptr, nullptr);
+        if (clientSocket < 0) {
+            continue;
+        }
+        handleRequest(clientSocket);
+        close(clientSocket);
+    }
+}
+
+void MetricsEndpoint::handleRequest(int clientSocket) {
+    struct timeval timeout = {1, 0};
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char request[1024];
+    ssize_t received = recv(clientSocket, request, sizeof(request) - 1, 0);
+    if (received <= 0) {
+        return;
+    }
+    request[received] = '\0';
+
+    std::string response;
+    if (std::strncmp(request, "GET ", 4) != 0) {
+        response = "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\n\r\n";
+    } else {
+        std::string body = metrics.render();
+        response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                   std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t result = send(clientSocket, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (result <= 0) {
+            return;
+        }
+        sent += result;
+    }
+}
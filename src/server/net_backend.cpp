@@ -0,0 +1,222 @@
+#include "net_backend.hpp"
+#include "uring.hpp"
+#include <algorithm>
+
+// Drains the queue in one wakeup rather than one connection per poll.
+// Accepted sockets are non-blocking: nothing the lobby or a room worker
+// does with them may wait on the peer.
+int NetBackend::acceptAll(int listenSocket, std::vector<int>& accepted) {
+    int count = 0;
+    while (true) {
+        struct sockaddr_storage clientAddr;
+        socklen_t addrLen = sizeof(clientAddr);
+        int clientSocket = accept4(listenSocket, (struct sockaddr*)&clientAddr, &addrLen,
+            SOCK_CLOEXEC | SOCK_NONBLOCK);
+
+        if (clientSocket < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Erreur lors de l'acceptation de la connexion: " << strerror(errno) << std::endl;
+            }
+            return count;
+        }
+
+        char clientIP[INET_ADDRSTRLEN] = "unix";
+        if (clientAddr.ss_family == AF_INET) {
+            inet_ntop(AF_INET, &(((struct sockaddr_in*)&clientAddr)->sin_addr), clientIP, INET_ADDRSTRLEN);
+        }
+        LOG_DEBUG("Connexion acceptée, IP: " << clientIP << ", socket: " << clientSocket);
+        accepted.push_back(clientSocket);
+        count++;
+    }
+}
+
+bool NetBackend::extractPackets(int socket, std::vector<char>& input, std::vector<NetEvent>& events) {
+    const size_t headerSize = Wire::HeaderLayout::SIZE;
+    size_t position = 0;
+
+    while (input.size() - position >= headerSize) {
+        PacketHeader header;
+        if (!Protocol::readHeader(input.data() + position, header)) {
+            return false;
+        }
+        if (header.length < 0 || header.length > MAX_BUFFER_SIZE) {
+            LOG_WARN("Données de paquet trop grandes pour le buffer");
+            return false;
+        }
+        size_t packetSize = headerSize + header.length;
+        if (input.size() - position < packetSize) {
+            break;
+        }
+        NetEvent event;
+        event.kind = NetEvent::PACKET;
+        event.socket = socket;
+        event.packetType = header.type;
+        event.offset = payloads.size();
+        event.length = header.length;
+        payloads.insert(payloads.end(), input.begin() + position + headerSize, input.begin() + position + packetSize);
+        events.push_back(event);
+        position += packetSize;
+    }
+    input.erase(input.begin(), input.begin() + position);
+    return true;
+}
+
+void NetBackend::watch(int socket, const std::vector<char>& unread) {
+    watch(socket);
+    std::vector<char>* input = watchedInput(socket);
+    if (input && !unread.empty()) {
+        input->assign(unread.begin(), unread.end());
+        unreadSockets.push_back(socket);
+    }
+}
+
+int NetBackend::extractUnread(std::vector<NetEvent>& events) {
+    size_t before = events.size();
+    for (int socket : unreadSockets) {
+        std::vector<char>* input = watchedInput(socket);
+        if (input && !extractPackets(socket, *input, events)) {
+            unwatch(socket);
+            NetEvent event;
+            event.kind = NetEvent::CLOSED;
+            event.socket = socket;
+            events.push_back(event);
+        }
+    }
+    unreadSockets.clear();
+    return events.size() - before;
+}
+
+void SendBatch::drop(PeerOutput& peer, const char* reason) {
+    LOG_WARN("Joueur déconnecté (" << reason << "), socket: " << peer.socket);
+    peer.dropped = true;
+    peer.batched = false;
+    peer.backlog.clear();
+    shutdown(peer.socket, SHUT_RDWR);
+}
+
+void DirectSendBatch::flush() {
+    for (PeerOutput* peer : peers) {
+        peer->batched = false;
+        if (!peer->backlog.flush(peer->socket, peer->counters)) {
+            drop(*peer, strerror(errno));
+        }
+    }
+    peers.clear();
+}
+
+std::unique_ptr<NetBackend> NetBackend::create(const std::string& name) {
+    if (name == "poll") {
+        return std::make_unique<PollBackend>();
+    }
+    if (name == "uring") {
+        return std::make_unique<UringBackend>();
+    }
+    return nullptr;
+}
+
+bool PollBackend::open(int listenSocket, const std::vector<int>& wakeFds) {
+    this->listenSocket = listenSocket;
+    this->wakeFds = wakeFds;
+    return true;
+}
+
+void PollBackend::watch(int socket) {
+    watched.push_back(socket);
+    if (static_cast<size_t>(socket) >= inputs.size()) {
+        inputs.resize(socket + 1);
+    }
+    inputs[socket].clear();
+}
+
+std::vector<char>* PollBackend::watchedInput(int socket) {
+    if (std::find(watched.begin(), watched.end(), socket) == watched.end()) {
+        return nullptr;
+    }
+    return &inputs[socket];
+}
+
+void PollBackend::unwatch(int socket) {
+    watched.erase(std::remove(watched.begin(), watched.end(), socket), watched.end());
+    if (static_cast<size_t>(socket) < inputs.size()) {
+        inputs[socket].clear();
+    }
+}
+
+int PollBackend::wait(int timeoutMs, std::vector<NetEvent>& events) {
+    payloads.clear();
+    size_t before = events.size();
+    if (extractUnread(events) > 0) {
+        timeoutMs = 0;
+    }
+    fds.clear();
+    fds.push_back({listenSocket, POLLIN, 0});
+    for (int wakeFd : wakeFds) {
+        fds.push_back({wakeFd, POLLIN, 0});
+    }
+    size_t firstWatched = fds.size();
+    for (int socket : watched) {
+        fds.push_back({socket, POLLIN, 0});
+    }
+
+    int ready = poll(fds.data(), fds.size(), timeoutMs);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        std::cerr << "Erreur de poll: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    for (size_t i = firstWatched; i < fds.size() && ready > 0; i++) {
+        if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+        }
+        int socket = fds[i].fd;
+        std::vector<char>& input = inputs[socket];
+        size_t kept = input.size();
+        input.resize(kept + MAX_BUFFER_SIZE);
+        ssize_t received = recv(socket, input.data() + kept, MAX_BUFFER_SIZE, MSG_DONTWAIT);
+        input.resize(kept + std::max<ssize_t>(received, 0));
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        if (received > 0 && extractPackets(socket, input, events)) {
+            continue;
+        }
+        if (received < 0) {
+            LOG_DEBUG("Erreur de réception, socket " << socket << ": " << strerror(errno));
+        }
+        unwatch(socket);
+        NetEvent event;
+        event.kind = NetEvent::CLOSED;
+        event.socket = socket;
+        events.push_back(event);
+    }
+
+    for (size_t i = 1; i < firstWatched; i++) {
+        if (fds[i].revents & POLLIN) {
+            NetEvent event;
+            event.kind = NetEvent::WAKE;
+            event.socket = fds[i].fd;
+            events.push_back(event);
+        }
+    }
+    if (fds[0].revents & POLLIN) {
+        accepted.clear();
+        acceptAll(listenSocket, accepted);
+        for (int socket : accepted) {
+            NetEvent event;
+            event.kind = NetEvent::ACCEPTED;
+            event.socket = socket;
+            events.push_back(event);
+        }
+    }
+    return events.size() - before;
+}
+
+std::unique_ptr<SendBatch> PollBackend::createSendBatch() {
+    return std::make_unique<DirectSendBatch>();
+}
@@ -0,0 +1,516 @@
+#include "room.hpp"
+#include <algorithm>
+#include <chrono>
+#include <linux/sockios.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+
+Room::Room(int id, const Map& map, const std::array<int, MAX_PLAYERS>& sockets, ServerMetrics& metrics)
+    : id(id), map(map), sockets(sockets), metrics(metrics) {
+    static_assert(MAX_PLAYERS <= 32, "lostDisconnects and the press masks hold one bit per slot");
+    visiblePlayers.reserve(MAX_PLAYERS);
+    columnPackets.reserve(MAX_PLAYERS);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        outputs[i].socket = sockets[i];
+        outputs[i].counters = &metrics.slotTraffic[i];
+    }
+}
+
+void Room::start() {
+    uint64_t seed = std::chrono::steady_clock::now().time_since_epoch().count();
+    simulation.start(map, seed);
+    simulation.setCollisionTiming(true);
+    if (!replayFile.empty() && replay.open(replayFile, simulation)) {
+        std::cout << "Enregistrement du replay de la partie " << id << " dans " << replayFile << std::endl;
+    }
+
+    // Still on the lobby thread: nothing to batch with yet.
+    DirectSendBatch direct;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        direct.queue(outputs[i], Protocol::encodeInt(ASSIGN_PLAYER_ID, i));
+    }
+    std::string mapString = map.toString();
+    mapPacket = Protocol::encodePacket(MAP_DATA, mapString.data(), mapString.size());
+    broadcast(direct, MAP_DATA, mapPacket);
+    gameState = RUNNING;
+    metrics.matchesStarted.fetch_add(1, std::memory_order_relaxed);
+    broadcastGameState(direct);
+    direct.flush();
+}
+
+// Spectators may be switched to a room mid-match: they get its map first,
+// then its stream from the next tick on.
+void Room::feature(SpectatorFeed* spectatorFeed) {
+    if (mapPacket) {
+        spectatorFeed->publish(MAP_DATA, mapPacket);
+    }
+    feed.store(spectatorFeed, std::memory_order_release);
+}
+
+bool Room::tick(SendBatch& out) {
+    if (gameState == OVER) {
+        return drainOutput(out);
+    }
+    int64_t tickStartNs = ServerMetrics::now();
+
+    applyCommands();
+    replay.recordTick(simulation);
+    simulation.step();
+    int64_t updateEndNs = ServerMetrics::now();
+    gameState = simulation.getState();
+    if (gameState == OVER) {
+        endGame(out);
+    }
+    int64_t broadcastStartNs = ServerMetrics::now();
+    broadcastGameState(out);
+    if (gameState == RUNNING && simulation.getTick() % PING_INTERVAL_TICKS == 0) {
+        sendPings(out);
+    }
+    // Players that got nothing new this tick may still have a backlog.
+    for (PeerOutput& output : outputs) {
+        out.resume(output);
+    }
+    int64_t tickEndNs = ServerMetrics::now();
+    metrics.tickUpdate.observe(updateEndNs - tickStartNs);
+    metrics.tickCollisions.observe(simulation.getCollisionNs());
+    metrics.tickBroadcast.observe(tickEndNs - broadcastStartNs);
+    metrics.tickTotal.observe(tickEndNs - tickStartNs);
+    metrics.ticks.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+// The GAME_OVER went out with the last tick; whatever full sockets held
+// back gets ROOM_DRAIN_TICKS more flushes before the room is let go.
+bool Room::drainOutput(SendBatch& out) {
+    bool pending = false;
+    for (PeerOutput& output : outputs) {
+        out.resume(output);
+        pending = pending || output.batched;
+    }
+    return pending && ++drainTicks < ROOM_DRAIN_TICKS;
+}
+
+void Room::handlePacket(int slot, int packetType, const char* data, int dataSize) {
+    TrafficCounters& counters = metrics.slotTraffic[slot];
+    counters.packetsReceived.fetch_add(1, std::memory_order_relaxed);
+    counters.bytesReceived.fetch_add(Wire::HeaderLayout::SIZE + dataSize, std::memory_order_relaxed);
+
+    switch (packetType) {
+        case PLAYER_POS: {
+            using Layout = Wire::PlayerPositionLayout;
+            if (dataSize < (int)Layout::SIZE) {
+                LOG_WARN("Paquet PLAYER_POS invalide: taille=" << dataSize);
+                break;
+            }
+            Wire::View<Layout> position(data);
+            
+            if (position.get<Layout::PlayerId>() == slot) {
+                RoomCommand command;
+                command.kind = RoomCommand::INPUT;
+                command.slot = slot;
+                command.jetpackOn = position.get<Layout::JetpackOn>() != 0;
+                if (!commands.push(command)) {
+                    metrics.commandsDropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else {
+                LOG_WARN("ID de joueur incorrect dans PLAYER_POS");
+            }
+            break;
+        }
+        
+        case PONG: {
+            using Layout = Wire::PongLayout;
+            if (dataSize < (int)Layout::SIZE) {
+                LOG_WARN("Paquet PONG invalide: taille=" << dataSize);
+                break;
+            }
+            // Timed on arrival here, where the lobby read it.
+            int64_t sentUs = Wire::View<Layout>(data).get<Layout::SentUs>();
+            int64_t rttUs = ServerMetrics::now() / 1000 - sentUs;
+            if (rttUs < 0 || rttUs > UINT32_MAX) {
+                LOG_WARN("PONG avec un horodatage invalide, joueur " << slot);
+                break;
+            }
+            RoomCommand command;
+            command.kind = RoomCommand::RTT_SAMPLE;
+            command.slot = slot;
+            command.rttUs = rttUs;
+            if (!commands.push(command)) {
+                metrics.commandsDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            break;
+        }
+
+        case READY: {
+            LOG_DEBUG("Partie " << id << ", joueur " << slot << " prêt");
+            break;
+        }
+        
+        default:
+            LOG_WARN("Type de paquet non géré: " << packetType);
+            break;
+    }
+}
+
+void Room::disconnect(int slot) {
+    RoomCommand command;
+    command.kind = RoomCommand::DISCONNECT;
+    command.slot = slot;
+    if (!commands.push(command)) {
+        lostDisconnects.fetch_or(1u << slot, std::memory_order_release);
+    }
+}
+
+void Room::closeSockets() {
+    for (int& socket : sockets) {
+        if (socket >= 0) {
+            close(socket);
+            socket = -1;
+        }
+    }
+}
+
+// At most one ring's worth per tick, so a player flooding input cannot
+// keep the room from ticking. The simulation only sees one jetpack state
+// per tick, so a press that was already released by then is held for the
+// tick instead of being lost.
+void Room::applyCommands() {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (releaseAfterStep & (1u << i)) {
+            simulation.setJetpack(i, false);
+        }
+    }
+    releaseAfterStep = 0;
+
+    uint32_t pressed = 0;
+    RoomCommand command;
+    for (int applied = 0; applied < ROOM_COMMAND_QUEUE_SIZE && commands.pop(command); applied++) {
+        switch (command.kind) {
+            case RoomCommand::INPUT:
+                if (command.jetpackOn) {
+                    pressed |= 1u << command.slot;
+                }
+                simulation.setJetpack(command.slot, command.jetpackOn);
+                break;
+            case RoomCommand::DISCONNECT:
+                if (simulation.isConnected(command.slot)) {
+                    simulation.disconnectPlayer(command.slot);
+                }
+                break;
+            case RoomCommand::RTT_SAMPLE:
+                links[command.slot].addSample(command.rttUs);
+                metrics.clientRtt.observe(static_cast<int64_t>(command.rttUs) * 1000);
+                break;
+        }
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if ((pressed & (1u << i)) && !simulation.getPlayers()[i].jetpackOn) {
+            simulation.setJetpack(i, true);
+            releaseAfterStep |= 1u << i;
+        }
+    }
+
+    if (lostDisconnects.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    uint32_t lost = lostDisconnects.exchange(0, std::memory_order_acquire);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if ((lost & (1u << i)) && simulation.isConnected(i)) {
+            simulation.disconnectPlayer(i);
+        }
+    }
+}
+
+void Room::broadcastGameState(SendBatch& out) {
+    const std::array<Player, MAX_PLAYERS>& players = simulation.getPlayers();
+    SharedPacket full = Protocol::encodeGameState(gameState, players, &packets);
+    publish(GAME_STATE, full);
+    if (gameState != RUNNING) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            if (simulation.isConnected(i)) {
+                out.queue(outputs[i], full);
+            }
+        }
+        return;
+    }
+
+    // Players get the part of the match around their own position;
+    // spectators follow anyone, so they keep the full snapshot.
+    uint32_t tick = simulation.getTick();
+    interest.build(players);
+    columnPackets.clear();
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!simulation.isConnected(i)) {
+            continue;
+        }
+        if (!links[i].sendsSnapshotOn(tick, i)) {
+            metrics.snapshotsSkipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        int column = InterestGrid::columnOf(players[i].position.x);
+        uint32_t snapshot = links[i].snapshotCount(tick);
+        uint32_t distantPhase = snapshot % INTEREST_DISTANT_TICKS;
+        SharedPacket packet;
+        for (const ColumnPacket& cached : columnPackets) {
+            if (cached.column == column && cached.distantPhase == distantPhase) {
+                packet = cached.packet;
+                break;
+            }
+        }
+        if (!packet) {
+            interest.select(column, snapshot, visiblePlayers);
+            packet = visiblePlayers.size() == MAX_PLAYERS ? full
+                : Protocol::encodeGameState(gameState, players, visiblePlayers, &packets);
+            columnPackets.push_back({column, distantPhase, packet});
+        }
+        out.queue(outputs[i], packet);
+    }
+
+    if (tick % LEADERBOARD_TICKS == 0) {
+        broadcast(out, LEADERBOARD, Protocol::encodeLeaderboard(players, &packets));
+    }
+}
+
+// Each ping also retunes the player's snapshot rate, from its latest RTT
+// and what has not managed to leave yet, in its socket or its backlog.
+void Room::sendPings(SendBatch& out) {
+    int64_t nowUs = ServerMetrics::now() / 1000;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!simulation.isConnected(i)) {
+            continue;
+        }
+        int queuedBytes = 0;
+        if (ioctl(sockets[i], SIOCOUTQ, &queuedBytes) < 0) {
+            queuedBytes = 0;
+        }
+        queuedBytes += outputs[i].backlog.bytes();
+        LinkQuality& link = links[i];
+        link.adapt(queuedBytes);
+        out.queue(outputs[i], Protocol::encodePing(nowUs, link.getRttUs(), link.getJitterUs(),
+            link.getSnapshotInterval(), &packets));
+    }
+}
+
+void Room::broadcast(SendBatch& out, int packetType, const SharedPacket& packet) {
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (simulation.isConnected(i)) {
+            out.queue(outputs[i], packet);
+        }
+    }
+    publish(packetType, packet);
+}
+
+void Room::publish(int packetType, const SharedPacket& packet) {
+    SpectatorFeed* spectatorFeed = feed.load(std::memory_order_acquire);
+    if (spectatorFeed) {
+        spectatorFeed->publish(packetType, packet);
+    }
+}
+
+void Room::endGame(SendBatch& out) {
+    int winnerId = simulation.getWinnerId();
+    LOG_DEBUG("Fin de la partie " << id << ", gagnant: Joueur " << winnerId);
+    
+    metrics.matchesFinished.fetch_add(1, std::memory_order_relaxed);
+    replay.finish(simulation);
+    std::array<int, MAX_PLAYERS> scores;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        scores[i] = simulation.getPlayers()[i].score;
+    }
+    broadcast(out, GAME_OVER, Protocol::encodeGameOver(winnerId, scores, &packets));
+}
+
+namespace {
+    const std::chrono::nanoseconds TICK_DURATION(1000000000 / Simulation::TICKS_PER_SECOND);
+
+    template <typename Entry>
+    bool laterDeadline(const Entry& a, const Entry& b) {
+        return a->deadline > b->deadline;
+    }
+}
+
+RoomScheduler::~RoomScheduler() {
+    stop();
+}
+
+bool RoomScheduler::start(int workerCount, bool pinToCores, NetBackend& backend) {
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    if (workerCount <= 0) {
+        workerCount = cores;
+    }
+    for (int i = 0; i < workerCount; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->id = i;
+        worker->sendBatch = backend.createSendBatch();
+        if (!worker->sendBatch) {
+            workers.clear();
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    running = true;
+    epoch = Clock::now();
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        worker->thread = std::thread(&RoomScheduler::run, this, std::ref(*worker));
+        if (pinToCores) {
+            pin(*worker, worker->id % cores);
+        }
+    }
+    return true;
+}
+
+// Taking each worker's lock after clearing running means none of them is
+// between checking it and going to sleep when it is notified.
+void RoomScheduler::stop() {
+    running = false;
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+        }
+        worker->wakeup.notify_all();
+    }
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers.clear();
+    roomCount = 0;
+}
+
+// A new room goes to the worker with the fewest and is due at once. The
+// first one also wakes the workers that sleep while no match runs, so they
+// start looking for rooms to steal.
+void RoomScheduler::dispatch(const std::shared_ptr<Room>& room) {
+    if (workers.empty()) {
+        return;
+    }
+    Worker* leastLoaded = workers.front().get();
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        if (worker->homeRooms.load(std::memory_order_relaxed) < leastLoaded->homeRooms.load(std::memory_order_relaxed)) {
+            leastLoaded = worker.get();
+        }
+    }
+    // On the grid every room's ticks fall on, so rooms due together are
+    // ticked in one wakeup and flushed in one batch.
+    auto entry = std::make_unique<Scheduled>();
+    entry->room = room;
+    entry->deadline = epoch + (Clock::now() - epoch) / TICK_DURATION * TICK_DURATION;
+    leastLoaded->homeRooms.fetch_add(1, std::memory_order_relaxed);
+    bool first = roomCount.fetch_add(1, std::memory_order_relaxed) == 0;
+    {
+        std::lock_guard<std::mutex> lock(leastLoaded->mutex);
+        push(*leastLoaded, std::move(entry));
+    }
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        if (first || worker.get() == leastLoaded) {
+            worker->wakeup.notify_one();
+        }
+    }
+}
+
+void RoomScheduler::pin(Worker& worker, int core) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    int result = pthread_setaffinity_np(worker.thread.native_handle(), sizeof(cpus), &cpus);
+    if (result != 0) {
+        std::cerr << "Impossible d'attacher le worker " << worker.id << " au cœur " << core
+                  << ": " << strerror(result) << std::endl;
+    }
+}
+
+// Under the worker's lock.
+void RoomScheduler::push(Worker& worker, std::unique_ptr<Scheduled> entry) {
+    worker.rooms.push_back(std::move(entry));
+    std::push_heap(worker.rooms.begin(), worker.rooms.end(), laterDeadline<std::unique_ptr<Scheduled>>);
+}
+
+void RoomScheduler::run(Worker& self) {
+    while (running) {
+        Clock::time_point now = Clock::now();
+        while (std::unique_ptr<Scheduled> entry = take(self, now)) {
+            if (entry->room->tick(*self.sendBatch)) {
+                self.ticked.push_back(std::move(entry));
+            } else {
+                self.ended.push_back(std::move(entry));
+            }
+        }
+
+        self.sendBatch->flush();
+        for (const std::unique_ptr<Scheduled>& entry : self.ended) {
+            LOG_DEBUG("Worker " << self.id << ": partie " << entry->room->getId() << " terminée");
+            entry->room->markFinished();
+            self.homeRooms.fetch_sub(1, std::memory_order_relaxed);
+            roomCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+        self.ended.clear();
+        reschedule(self, Clock::now());
+        sleep(self);
+    }
+}
+
+// A due room from the top of the worker's own heap, or else from the top
+// of another's, which it then adopts.
+std::unique_ptr<RoomScheduler::Scheduled> RoomScheduler::take(Worker& self, Clock::time_point now) {
+    auto byDeadline = laterDeadline<std::unique_ptr<Scheduled>>;
+    for (size_t offset = 0; offset < workers.size(); offset++) {
+        Worker& owner = *workers[(self.id + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(owner.mutex);
+        if (owner.rooms.empty() || owner.rooms.front()->deadline > now) {
+            continue;
+        }
+        std::pop_heap(owner.rooms.begin(), owner.rooms.end(), byDeadline);
+        std::unique_ptr<Scheduled> entry = std::move(owner.rooms.back());
+        owner.rooms.pop_back();
+        if (&owner != &self) {
+            owner.homeRooms.fetch_sub(1, std::memory_order_relaxed);
+            self.homeRooms.fetch_add(1, std::memory_order_relaxed);
+            metrics.ticksStolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        return entry;
+    }
+    return nullptr;
+}
+
+// Each room is due one tick after its last deadline. One that is already
+// past that too skips what it missed and keeps its own phase.
+void RoomScheduler::reschedule(Worker& self, Clock::time_point now) {
+    if (self.ticked.empty()) {
+        return;
+    }
+    for (const std::unique_ptr<Scheduled>& entry : self.ticked) {
+        entry->deadline += TICK_DURATION;
+        if (entry->deadline <= now) {
+            auto missed = (now - entry->deadline) / TICK_DURATION + 1;
+            entry->deadline += missed * TICK_DURATION;
+            metrics.ticksSkipped.fetch_add(missed, std::memory_order_relaxed);
+        }
+    }
+    std::lock_guard<std::mutex> lock(self.mutex);
+    for (std::unique_ptr<Scheduled>& entry : self.ticked) {
+        push(self, std::move(entry));
+    }
+    self.ticked.clear();
+}
+
+// Until the worker's next room is due, and no later than the next tick of
+// the grid while other workers have rooms it could steal.
+void RoomScheduler::sleep(Worker& self) {
+    std::unique_lock<std::mutex> lock(self.mutex);
+    if (!running) {
+        return;
+    }
+    bool othersBusy = roomCount.load(std::memory_order_relaxed) > static_cast<int>(self.rooms.size());
+    if (self.rooms.empty() && !othersBusy) {
+        self.wakeup.wait(lock);
+        return;
+    }
+    Clock::time_point until = epoch + ((Clock::now() - epoch) / TICK_DURATION + 1) * TICK_DURATION;
+    if (!self.rooms.empty() && (!othersBusy || self.rooms.front()->deadline < until)) {
+        until = self.rooms.front()->deadline;
+    }
+    self.wakeup.wait_until(lock, until);
+}
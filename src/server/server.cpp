@@ -1,21 +1,27 @@
 #include "server.hpp"
+#include <algorithm>
 #include <chrono>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
 #include <thread>
 
 Server::Server(int port, const std::string& mapFile)
-    : port(port), mapFile(mapFile) {
-    for (int& socket : clientSockets) {
-        socket = -1;
-    }
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        players[i].id = i;
-        players[i].alive = true;
-    }
+    : port(port), mapFile(mapFile), stopFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
 }
 
 Server::~Server() {
     stop();
+    if (stopFd >= 0) {
+        close(stopFd);
+    }
+}
+
+// Nothing here may log: it can run inside a signal handler. A write that
+// fails with EAGAIN finds a request already pending.
+void Server::requestStop() {
+    uint64_t one = 1;
+    ssize_t written = stopFd >= 0 ? write(stopFd, &one, sizeof(one)) : 0;
+    (void)written;
 }
 
 bool Server::start() {
@@ -23,428 +29,525 @@ bool Server::start() {
         std::cerr << "Impossible de charger la carte: " << mapFile << std::endl;
         return false;
     }
-    
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        std::cerr << "Erreur lors de la création du socket" << std::endl;
+    backend = NetBackend::create(backendName);
+    if (!backend) {
+        std::cerr << "Backend d'E/S inconnu: " << backendName << std::endl;
         return false;
     }
     
-    struct sockaddr_in serverAddr;
-    std::memset(&serverAddr, 0, sizeof(serverAddr));
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
-    
-    int opt = 1;
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        std::cerr << "Erreur lors de la configuration du socket" << std::endl;
-        close(serverSocket);
+    if (listenerThreadCount > 0) {
+        if (!openListenerThreads()) {
+            return false;
+        }
+    } else {
+        serverSocket = openListenSocket(false);
+        if (serverSocket < 0) {
+            return false;
+        }
+    }
+    if (unixSocketPath.empty()) {
+        std::cout << "Serveur démarré sur le port " << port << std::endl;
+    } else {
+        std::cout << "Serveur démarré sur " << unixSocketPath << std::endl;
+    }
+    if (stopFd < 0 || !handshakes.open()) {
+        stop();
         return false;
     }
-    
-    if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
-        std::cerr << "Erreur lors du bind du socket" << std::endl;
-        close(serverSocket);
+    std::vector<int> wakeFds = {handshakes.descriptor(), stopFd};
+    if (wakeFd >= 0) {
+        wakeFds.push_back(wakeFd);
+    }
+    if (!backend->open(serverSocket, wakeFds)) {
+        stop();
         return false;
     }
-    
-    if (listen(serverSocket, 5) < 0) {
-        std::cerr << "Erreur lors de l'écoute des connexions" << std::endl;
-        close(serverSocket);
+    if (metricsPort > 0 && !metricsEndpoint.start(metricsPort)) {
+        stop();
         return false;
     }
-    std::cout << "Serveur démarré sur le port " << port << std::endl;
-    std::cout << "En attente de " << MAX_PLAYERS << " joueurs..." << std::endl;
+    if (!scheduler.start(roomWorkerCount, pinRoomWorkers, *backend)) {
+        stop();
+        return false;
+    }
+    std::cout << "File d'attente ouverte, parties de " << MAX_PLAYERS << " joueurs sur "
+              << scheduler.workerCount() << " workers, E/S: " << backend->name() << std::endl;
     running = true;
     handleConnections();
     return true;
 }
 
-void Server::stop() {
-    running = false;
-    
-    for (int& clientSocket : clientSockets) {
-        if (clientSocket >= 0) {
-            close(clientSocket);
-            clientSocket = -1;
+// The listening socket is non-blocking so a wakeup can drain every queued
+// connection. With reusePort, several sockets share the port and the kernel
+// spreads incoming connections across them.
+int Server::openListenSocket(bool reusePort) {
+    int listenSocket;
+    if (!unixSocketPath.empty()) {
+        struct sockaddr_un unixAddr;
+        std::memset(&unixAddr, 0, sizeof(unixAddr));
+        unixAddr.sun_family = AF_UNIX;
+        if (unixSocketPath.size() >= sizeof(unixAddr.sun_path)) {
+            std::cerr << "Chemin de socket UNIX trop long: " << unixSocketPath << std::endl;
+            return -1;
+        }
+        std::strncpy(unixAddr.sun_path, unixSocketPath.c_str(), sizeof(unixAddr.sun_path) - 1);
+
+        listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenSocket < 0) {
+            std::cerr << "Erreur lors de la création du socket" << std::endl;
+            return -1;
+        }
+        unlink(unixSocketPath.c_str());
+        if (bind(listenSocket, (struct sockaddr*)&unixAddr, sizeof(unixAddr)) < 0) {
+            std::cerr << "Erreur lors du bind du socket" << std::endl;
+            close(listenSocket);
+            return -1;
+        }
+    } else {
+        listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenSocket < 0) {
+            std::cerr << "Erreur lors de la création du socket" << std::endl;
+            return -1;
+        }
+
+        struct sockaddr_in serverAddr;
+        std::memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_addr.s_addr = INADDR_ANY;
+        serverAddr.sin_port = htons(port);
+
+        int opt = 1;
+        if (setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+            (reusePort && setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
+            std::cerr << "Erreur lors de la configuration du socket" << std::endl;
+            close(listenSocket);
+            return -1;
+        }
+
+        if (bind(listenSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
+            std::cerr << "Erreur lors du bind du socket" << std::endl;
+            close(listenSocket);
+            return -1;
         }
     }
-    
-    if (serverSocket >= 0) {
-        close(serverSocket);
-        serverSocket = -1;
+
+    // The kernel silently caps the backlog at net.core.somaxconn.
+    if (listen(listenSocket, listenBacklog) < 0) {
+        std::cerr << "Erreur lors de l'écoute des connexions" << std::endl;
+        close(listenSocket);
+        return -1;
     }
-    
-    std::cout << "Serveur arrêté" << std::endl;
+    return listenSocket;
 }
 
-bool Server::acceptClient() {
-    struct sockaddr_in clientAddr;
-    socklen_t addrLen = sizeof(clientAddr);
-    int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &addrLen);
-    
-    if (clientSocket < 0) {
-        std::cerr << "Erreur lors de l'acceptation de la connexion" << std::endl;
+bool Server::openListenerThreads() {
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        std::cerr << "Erreur lors de la création de l'eventfd" << std::endl;
         return false;
     }
-    
-    char clientIP[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &(clientAddr.sin_addr), clientIP, INET_ADDRSTRLEN);
-    
-    int clientIndex = -1;
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (clientSockets[i] < 0) {
-            clientSockets[i] = clientSocket;
-            clientIndex = i;
-            break;
+    for (int i = 0; i < listenerThreadCount; i++) {
+        int listenSocket = openListenSocket(true);
+        if (listenSocket < 0) {
+            stop();
+            return false;
         }
+        listenerSockets.push_back(listenSocket);
     }
-    
-    if (clientIndex < 0) {
-        close(clientSocket);
-        return false;
-    }
-    
-    debugPrint("Client accepté avec index " + std::to_string(clientIndex) + 
-              ", IP: " + std::string(clientIP) + ", socket: " + std::to_string(clientSocket));
-    
-    players[clientIndex].id = clientIndex;
-    players[clientIndex].score = 0;
-    players[clientIndex].alive = true;
-    
-    int connectedClients = getConnectedClientCount();
-    debugPrint("Total clients connectés: " + std::to_string(connectedClients));
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (clientSockets[i] >= 0) {
-            Protocol::sendWaitingStatus(clientSockets[i], connectedClients);
-        }
+    // The threads check this flag, so it is raised before they start.
+    running = true;
+    for (int listenSocket : listenerSockets) {
+        listenerThreads.emplace_back(&Server::listenerLoop, this, listenSocket);
     }
-    
+    std::cout << listenerThreadCount << " threads d'écoute (SO_REUSEPORT)" << std::endl;
     return true;
 }
 
-void Server::handleClientMessage(int clientIndex) {
-    if (clientSockets[clientIndex] < 0) return;
-    
-    char buffer[MAX_BUFFER_SIZE];
-    int packetType;
+// Also run by the destructor: the backend is its mark of a server that was
+// started and not stopped yet.
+void Server::stop() {
+    running = false;
+    if (!backend) {
+        return;
+    }
+    metricsEndpoint.stop();
+    for (std::thread& listenerThread : listenerThreads) {
+        listenerThread.join();
+    }
+    listenerThreads.clear();
+    for (int listenSocket : listenerSockets) {
+        close(listenSocket);
+    }
+    listenerSockets.clear();
+    for (int acceptedSocket : acceptedSockets) {
+        close(acceptedSocket);
+    }
+    acceptedSockets.clear();
+    if (wakeFd >= 0) {
+        close(wakeFd);
+        wakeFd = -1;
+    }
     
-    int dataSize = Protocol::receivePacket(clientSockets[clientIndex], packetType, buffer, MAX_BUFFER_SIZE);
+    scheduler.stop();
+    // Lets go of every socket before they are closed below.
+    backend.reset();
+    for (const std::shared_ptr<Room>& room : rooms) {
+        room->closeSockets();
+    }
+    rooms.clear();
+    players.clear();
+    matchmaker.closeAll();
+    metrics.queueDepth.store(0, std::memory_order_relaxed);
+    // Each greeting finds its entry gone when it wakes up and just ends.
+    for (const auto& pending : pendingSockets) {
+        pending.second.session->close();
+    }
+    pendingSockets.clear();
+    keepaliveTimers.clear();
+    timers = TimerWheel(ServerMetrics::now() / 1000000);
+    spectators.closeAll();
     
-    if (dataSize <= 0) {
-        close(clientSockets[clientIndex]);
-        clientSockets[clientIndex] = -1;
-        players[clientIndex].alive = false;
-        
-        if (gameState == RUNNING) {
-            checkGameEndCondition();
+    if (serverSocket >= 0) {
+        close(serverSocket);
+        serverSocket = -1;
+        if (!unixSocketPath.empty()) {
+            unlink(unixSocketPath.c_str());
         }
-        return;
     }
     
-    switch (packetType) {
-        case PLAYER_POS: {
-            if (dataSize < 16) {
-                debugPrint("Paquet PLAYER_POS invalide: taille=" + std::to_string(dataSize));
-                return;
-            }
-            int player_id;
-            float x, y;
-            int jetpack_on;
-            int offset = 0;
-            
-            std::memcpy(&player_id, buffer + offset, sizeof(int));
-            offset += sizeof(int);
-            std::memcpy(&x, buffer + offset, sizeof(float));
-            offset += sizeof(float);
-            std::memcpy(&y, buffer + offset, sizeof(float));
-            offset += sizeof(float);
-            std::memcpy(&jetpack_on, buffer + offset, sizeof(int));
-            
-            if (player_id == clientIndex) {
-                bool oldState = players[clientIndex].jetpackOn;
-                players[clientIndex].jetpackOn = (jetpack_on != 0);
-            } else {
-                debugPrint("ID de joueur incorrect dans PLAYER_POS");
-            }
-            break;
+    std::cout << "Serveur arrêté" << std::endl;
+}
+
+void Server::listenerLoop(int listenSocket) {
+    std::vector<int> accepted;
+    pollfd fd = {listenSocket, POLLIN, 0};
+
+    while (running) {
+        if (poll(&fd, 1, POLL_TIMEOUT) <= 0 || !(fd.revents & POLLIN)) {
+            continue;
         }
-        
-        case READY: {
-            debugPrint("Client " + std::to_string(clientIndex) + " prêt");
-            break;
+        accepted.clear();
+        if (NetBackend::acceptAll(listenSocket, accepted) == 0) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(acceptedMutex);
+            acceptedSockets.insert(acceptedSockets.end(), accepted.begin(), accepted.end());
+        }
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOG_WARN("Impossible de réveiller le lobby: " << strerror(errno));
         }
-        
-        default:
-            debugPrint("Type de paquet non géré: " + std::to_string(packetType));
-            break;
     }
 }
 
-void Server::handleConnections() {
-    std::vector<pollfd> fds;
+void Server::takeAcceptedSockets() {
+    uint64_t wakeups;
+    if (read(wakeFd, &wakeups, sizeof(wakeups)) < 0 && errno != EAGAIN) {
+        LOG_WARN("Lecture de l'eventfd impossible: " << strerror(errno));
+    }
+    std::lock_guard<std::mutex> lock(acceptedMutex);
+    for (int clientSocket : acceptedSockets) {
+        adoptClient(clientSocket);
+    }
+    acceptedSockets.clear();
+}
 
-    while (running) {
-        fds.clear();
-        fds.push_back({serverSocket, POLLIN, 0});
-        for (int clientSocket : clientSockets) {
-            if (clientSocket >= 0) {
-                fds.push_back({clientSocket, POLLIN, 0});
-            }
-        }
+// The role is only known from the first packet: READY for a player,
+// SPECTATE for a spectator.
+void Server::adoptClient(int clientSocket) {
+    metrics.connectionsAccepted.fetch_add(1, std::memory_order_relaxed);
+    handshakes.spawn(greet(clientSocket));
+    // The first packet is often there already.
+    handshakes.runReady();
+}
 
-        int connectedClients = getConnectedClientCount();
-        int ready = poll(fds.data(), fds.size(), POLL_TIMEOUT);
+// Reads the first packet without ever blocking the lobby; a peer that
+// sends part of it and stops only holds its own coroutine until the
+// handshake timer closes its session.
+Task<> Server::greet(int clientSocket) {
+    AsyncSession session(handshakes);
+    if (!session.adopt(clientSocket)) {
+        co_return;
+    }
+    TimerWheel::Id timer = timers.schedule(HANDSHAKE_TIMEOUT_MS,
+        [this, clientSocket]() { expireHandshake(clientSocket); });
+    pendingSockets[clientSocket] = {&session, timer};
 
-        if (ready <= 0) {
-            if (ready < 0 && errno != EINTR) {
-                std::cerr << "Erreur de poll: " << strerror(errno) << std::endl;
-                break;
-            }
-            continue;
-        }
+    AsyncSession::Frame frame;
+    bool received = co_await session.readFrame(frame);
+    // Gone when the handshake expired, or the server stopped, meanwhile.
+    auto pending = pendingSockets.find(clientSocket);
+    if (pending == pendingSockets.end() || pending->second.session != &session) {
+        co_return;
+    }
+    timers.cancel(pending->second.timer);
+    pendingSockets.erase(pending);
+    if (!received) {
+        co_return;
+    }
 
-        if (fds[0].revents & POLLIN) {
-            if (acceptClient()) {
-                int connectedClients = getConnectedClientCount();
-                debugPrint("Total clients connectés: " + std::to_string(connectedClients));
-                std::cout << "Client connecté, " << connectedClients << "/" << MAX_PLAYERS << " joueurs" << std::endl;
+    // A player may already have sent more: it goes to the backend, which
+    // reads the socket from now on. Spectators are not listened to, so
+    // what follows their SPECTATE is discarded like the rest.
+    std::vector<char> unread;
+    if (frame.type == READY) {
+        int playerSocket = session.release(unread);
+        enqueuePlayer(playerSocket, frame.data, frame.length, unread);
+    } else if (frame.type == SPECTATE) {
+        addSpectator(session.release(unread));
+    } else {
+        LOG_WARN("Premier paquet inattendu: " << frame.type);
+    }
+}
 
-                for (int i = 0; i < MAX_PLAYERS; i++) {
-                    if (clientSockets[i] >= 0) {
-                        Protocol::sendWaitingStatus(clientSockets[i], connectedClients);
-                    }
-                }
-
-                if (connectedClients >= MAX_PLAYERS) {
-                    std::cout << "Tous les joueurs sont connectés, démarrage de la partie" << std::endl;
-
-                    const std::vector<Vector2>& startPositions = gameMap.getStartPositions();
-                    const float CELL_SIZE = 32.0f;
-                    for (size_t i = 0; i < MAX_PLAYERS && i < startPositions.size(); i++) {
-                        players[i].position.x = startPositions[i].x * CELL_SIZE;
-                        players[i].position.y = startPositions[i].y * CELL_SIZE;
-                        players[i].velocityY = 0.0f;
-                        players[i].jetpackOn = false;
-                    }
+// Closing the session wakes its greeting, which then finds it expired.
+void Server::expireHandshake(int clientSocket) {
+    LOG_DEBUG("Aucun paquet d'ouverture reçu, fermeture du socket " << clientSocket);
+    auto pending = pendingSockets.find(clientSocket);
+    AsyncSession* session = pending->second.session;
+    pendingSockets.erase(pending);
+    session->close();
+    handshakes.runReady();
+}
 
-                    for (int i = 0; i < MAX_PLAYERS; i++) {
-                        if (clientSockets[i] >= 0) {
-                            Protocol::sendMap(clientSockets[i], gameMap);
-                        }
-                    }
-                    gameState = RUNNING;
-                    broadcastGameState();
-                    std::thread gameThread(&Server::gameLoop, this);
-                    gameThread.detach();
-                }
-            }
-        }
+void Server::enqueuePlayer(int clientSocket, const char* data, int dataSize, const std::vector<char>& unread) {
+    QueueEntry entry;
+    entry.socket = clientSocket;
+    entry.enqueuedNs = ServerMetrics::now();
+    if (dataSize >= (int)Wire::IntLayout::SIZE) {
+        entry.skillRating = Wire::View<Wire::IntLayout>(data).get<Wire::IntLayout::Value>();
     }
+    entry.latencyMs = measureLatencyMs(clientSocket);
+    matchmaker.enqueue(entry);
+    backend->watch(clientSocket, unread);
+
+    int queued = matchmaker.depth();
+    metrics.queueDepth.store(queued, std::memory_order_relaxed);
+    LOG_DEBUG("Joueur en file, socket: " << clientSocket << ", niveau " << entry.skillRating
+              << ", latence " << entry.latencyMs << " ms, " << queued << " en attente");
+    sendWaitingStatus(clientSocket, queued);
+    keepaliveTimers[clientSocket] = timers.schedule(QUEUE_KEEPALIVE_MS,
+        [this, clientSocket]() { sendKeepalive(clientSocket); });
 }
 
-void Server::gameLoop() {
-    const int TICKS_PER_SECOND = 60;
-    const std::chrono::milliseconds TICK_DURATION(1000 / TICKS_PER_SECOND);
-    const float GRACE_PERIOD = 2.0f;
-    gameStartTime = std::chrono::steady_clock::now();
-    bool gracePeriod = true;
-    
-    while (running && gameState == RUNNING) {
-        auto startTime = std::chrono::steady_clock::now();
-        
-        if (gracePeriod) {
-            auto elapsedTime = std::chrono::duration_cast<std::chrono::seconds>(
-                startTime - gameStartTime).count();
-            if (elapsedTime >= GRACE_PERIOD) {
-                gracePeriod = false;
-                debugPrint("Période de grâce terminée");
-            }
-        }
-        updateGameState();
-        if (gracePeriod) {
-            for (int i = 0; i < MAX_PLAYERS; i++) {
-                if (!players[i].alive) {
-                    players[i].alive = true;
-                    debugPrint("[RESURRECTION] Joueur " + std::to_string(i) + 
-                              " ressuscité pendant la période de grâce");
-                }
-            }
-        }
-        broadcastGameState();
-        auto endTime = std::chrono::steady_clock::now();
-        auto elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        if (elapsedTime < TICK_DURATION) {
-            std::this_thread::sleep_for(TICK_DURATION - elapsedTime);
-        }
+void Server::sendKeepalive(int clientSocket) {
+    sendWaitingStatus(clientSocket, matchmaker.depth());
+    keepaliveTimers[clientSocket] = timers.schedule(QUEUE_KEEPALIVE_MS,
+        [this, clientSocket]() { sendKeepalive(clientSocket); });
+}
+
+// The socket is non-blocking: one that cannot take a dozen bytes belongs
+// to a peer that stopped reading. It is shut down rather than closed, so
+// the hang-up reaches the lobby as a CLOSED event, which takes the player
+// out of the queue.
+void Server::sendWaitingStatus(int clientSocket, int queued) {
+    if (!Protocol::sendWaitingStatus(clientSocket, queued)) {
+        shutdown(clientSocket, SHUT_RDWR);
     }
 }
 
-void Server::updateGameState() {
-    const float CELL_SIZE = 32.0f;
-    const float FLOOR_Y = 486.0f;
-    const float JET_ACCEL = -1.5f;
-    const float GRAV_ACCEL = 0.5f;
-    const float HORIZ_SPEED = 4.0f;
-    const float MAX_FALL = 10.0f;
-    const float MAX_RISE = -10.0f;
-    const float DAMP_FACTOR = 0.97f;
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (!players[i].alive) 
-            continue;
+void Server::cancelKeepalive(int clientSocket) {
+    auto keepalive = keepaliveTimers.find(clientSocket);
+    if (keepalive != keepaliveTimers.end()) {
+        timers.cancel(keepalive->second);
+        keepaliveTimers.erase(keepalive);
+    }
+}
 
-        float oldY = players[i].position.y;
-        float oldVelocityY = players[i].velocityY;
-        
-        if (players[i].jetpackOn) {
-            players[i].velocityY += JET_ACCEL;
-        }
-        oldVelocityY = players[i].velocityY;
-        players[i].velocityY += GRAV_ACCEL;
-        oldVelocityY = players[i].velocityY;
-        players[i].velocityY *= DAMP_FACTOR;
-        
-        if (players[i].velocityY > MAX_FALL) {
-            players[i].velocityY = MAX_FALL;
-        } else if (players[i].velocityY < MAX_RISE) {
-            players[i].velocityY = MAX_RISE;
-        }
-        
-        oldY = players[i].position.y;
-        players[i].position.y += players[i].velocityY;
-        players[i].position.x += HORIZ_SPEED;
-        
-        if (players[i].position.y < 0) {
-            players[i].position.y = 0;
-            players[i].velocityY = 0;
-        } else if (players[i].position.y > FLOOR_Y) {
-            players[i].position.y = FLOOR_Y;
-            players[i].velocityY = 0;
-        }
+// Input arrives at the game rate, so rather than rearming a timer on every
+// packet the timer is checked when it fires and pushed back by however
+// long the player has been quiet.
+void Server::checkIdle(int clientSocket) {
+    auto link = players.find(clientSocket);
+    if (link == players.end()) {
+        return;
+    }
+    int64_t idleMs = nowMs - link->second.lastPacketMs;
+    if (idleMs < PLAYER_IDLE_TIMEOUT_MS) {
+        link->second.idleTimer = timers.schedule(PLAYER_IDLE_TIMEOUT_MS - idleMs,
+            [this, clientSocket]() { checkIdle(clientSocket); });
+        return;
+    }
 
-        bool wasAlive = players[i].alive;
-        checkCollisions(i);
-        if (wasAlive && !players[i].alive) {
-            debugPrint("Joueur " + std::to_string(i) + " est mort lors de checkCollisions");
-            continue;
-        }
-        
-        if (players[i].position.x >= gameMap.getWidth() * CELL_SIZE - PLAYER_WIDTH) {
-            debugPrint("Joueur " + std::to_string(i) + " a atteint la fin du niveau");
-            endGame(i);
-            return;
-        }
+    LOG_DEBUG("Joueur inactif depuis " << idleMs << " ms, socket: " << clientSocket);
+    // Like a hang-up: the room keeps the socket until the match ends.
+    link->second.room->disconnect(link->second.slot);
+    backend->unwatch(clientSocket);
+    players.erase(link);
+    metrics.connectedClients.store(players.size(), std::memory_order_relaxed);
+}
+
+// Round-trip time the kernel measured over the TCP handshake; UNIX sockets
+// have none and count as local.
+int Server::measureLatencyMs(int clientSocket) const {
+    struct tcp_info info;
+    socklen_t length = sizeof(info);
+    if (getsockopt(clientSocket, IPPROTO_TCP, TCP_INFO, &info, &length) < 0) {
+        return 0;
     }
+    return info.tcpi_rtt / 1000;
 }
 
-void Map::setCell(int x, int y, CellType cellType) {
-    if (x >= 0 && x < width && y >= 0 && y < height) {
-        data[y * width + x] = cellType;
+void Server::handleClosed(int clientSocket) {
+    auto link = players.find(clientSocket);
+    if (link != players.end()) {
+        // The room closes the socket when the match ends; until then it
+        // only stops being read.
+        link->second.room->disconnect(link->second.slot);
+        timers.cancel(link->second.idleTimer);
+        players.erase(link);
+        metrics.connectedClients.store(players.size(), std::memory_order_relaxed);
+        return;
+    }
+    if (matchmaker.remove(clientSocket)) {
+        cancelKeepalive(clientSocket);
+        metrics.queueDepth.store(matchmaker.depth(), std::memory_order_relaxed);
+        LOG_DEBUG("Joueur parti de la file, socket: " << clientSocket);
     }
+    close(clientSocket);
 }
 
-void Server::checkCollisions(int playerIndex) {
-    Player& player = players[playerIndex];
-    
-    const float CELL_SIZE = 32.0f;
-    int startTileX = static_cast<int>(player.position.x / CELL_SIZE);
-    int endTileX = static_cast<int>((player.position.x + PLAYER_WIDTH - 1) / CELL_SIZE);
-    int startTileY = static_cast<int>(player.position.y / CELL_SIZE);
-    int endTileY = static_cast<int>((player.position.y + PLAYER_HEIGHT - 1) / CELL_SIZE);
-    
-    for (int tileY = startTileY; tileY <= endTileY; tileY++) {
-        for (int tileX = startTileX; tileX <= endTileX; tileX++) {
-            if (tileX < 0 || tileX >= gameMap.getWidth() || tileY < 0 || tileY >= gameMap.getHeight()) {
-                continue;
-            }
-            
-            CellType cell = gameMap.getCell(tileX, tileY);
-            
-            if (cell == COIN) {
-                player.score++;
-                gameMap.setCell(tileX, tileY, EMPTY);
-            } 
-            else if (cell == ELECTRIC) {
-                player.alive = false;
-                checkGameEndCondition();
-                return;
-            }
-        }
+void Server::addSpectator(int clientSocket) {
+    if (!spectatorFeed.join(clientSocket)) {
+        metrics.connectionsRejected.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
-void Server::checkCoinCollisions(int playerIndex) {
-    Player& player = players[playerIndex];
-    
-    const float CELL_SIZE = 32.0f;
-    int startTileX = static_cast<int>(player.position.x / CELL_SIZE);
-    int endTileX = static_cast<int>((player.position.x + PLAYER_WIDTH - 1) / CELL_SIZE);
-    int startTileY = static_cast<int>(player.position.y / CELL_SIZE);
-    int endTileY = static_cast<int>((player.position.y + PLAYER_HEIGHT - 1) / CELL_SIZE);
-    
-    for (int tileY = startTileY; tileY <= endTileY; tileY++) {
-        for (int tileX = startTileX; tileX <= endTileX; tileX++) {
-            if (tileX < 0 || tileX >= gameMap.getWidth() || tileY < 0 || tileY >= gameMap.getHeight()) {
-                continue;
-            }
-            
-            if (gameMap.getCell(tileX, tileY) == COIN) {
-                player.score++;
-                gameMap.setCell(tileX, tileY, EMPTY);
+void Server::handlePacket(int clientSocket, int packetType, const char* data, int dataSize) {
+    auto link = players.find(clientSocket);
+    if (link != players.end()) {
+        link->second.lastPacketMs = nowMs;
+        link->second.room->handlePacket(link->second.slot, packetType, data, dataSize);
+    }
+    // Queued players have nothing to say until their match starts.
+}
+
+void Server::handleConnections() {
+    std::vector<NetEvent> events;
+    nowMs = ServerMetrics::now() / 1000000;
+    timers.advance(nowMs);
+    sweepSpectators();
+
+    while (running) {
+        events.clear();
+        if (backend->wait(timers.timeoutMs(nowMs, POLL_TIMEOUT), events) < 0) {
+            break;
+        }
+        nowMs = ServerMetrics::now() / 1000000;
+
+        for (const NetEvent& event : events) {
+            switch (event.kind) {
+                case NetEvent::ACCEPTED:
+                    adoptClient(event.socket);
+                    break;
+                case NetEvent::WAKE:
+                    if (event.socket == handshakes.descriptor()) {
+                        handshakes.runReady();
+                    } else if (event.socket == stopFd) {
+                        running = false;
+                    } else {
+                        takeAcceptedSockets();
+                    }
+                    break;
+                case NetEvent::PACKET:
+                    handlePacket(event.socket, event.packetType, backend->payload(event), event.length);
+                    break;
+                case NetEvent::CLOSED:
+                    handleClosed(event.socket);
+                    break;
             }
         }
+
+        timers.advance(nowMs);
+        sweepRooms();
+        runMatchmaking();
     }
 }
 
-void Server::broadcastGameState() {
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (clientSockets[i] >= 0) {
-            Protocol::sendGameState(clientSockets[i], gameState, players);
+void Server::sweepSpectators() {
+    spectators.dropClosed();
+    timers.schedule(POLL_TIMEOUT, [this]() { sweepSpectators(); });
+}
+
+void Server::runMatchmaking() {
+    int64_t nowNs = ServerMetrics::now();
+    matchmaker.formMatches(nowNs, formedMatches);
+    for (const MatchGroup& match : formedMatches) {
+        for (const QueueEntry& entry : match) {
+            metrics.timeToMatch.observe(nowNs - entry.enqueuedNs);
         }
+        startRoom(match);
     }
+    metrics.queueDepth.store(matchmaker.depth(), std::memory_order_relaxed);
 }
 
-void Server::endGame(int winnerId) {
-    debugPrint("Fin de partie, gagnant: Joueur " + std::to_string(winnerId));
-    
-    gameState = OVER;
-    std::array<int, MAX_PLAYERS> scores;
+void Server::startRoom(const MatchGroup& match) {
+    std::array<int, MAX_PLAYERS> sockets;
     for (int i = 0; i < MAX_PLAYERS; i++) {
-        scores[i] = players[i].score;
+        sockets[i] = match[i].socket;
     }
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (clientSockets[i] >= 0) {
-            Protocol::sendGameOver(clientSockets[i], winnerId, scores);
-        }
+
+    int roomId = nextRoomId++;
+    auto room = std::make_shared<Room>(roomId, gameMap, sockets, metrics);
+    // The first match records to the given file, later ones next to it.
+    if (!replayFile.empty()) {
+        room->setReplayFile(roomId == 1 ? replayFile : replayFile + "." + std::to_string(roomId));
+    }
+    room->start();
+    if (featuredRoomId < 0) {
+        featuredRoomId = roomId;
+        room->feature(&spectatorFeed);
     }
-}
 
-void Server::checkGameEndCondition() {
-    int aliveCount = 0;
-    int lastAlivePlayer = -1;
-    
     for (int i = 0; i < MAX_PLAYERS; i++) {
-        if (players[i].alive) {
-            aliveCount++;
-            lastAlivePlayer = i;
-        }
-    }
-    
-    if (aliveCount <= 1 && gameState == RUNNING) {
-        endGame(lastAlivePlayer);
+        int socket = sockets[i];
+        cancelKeepalive(socket);
+        PlayerLink link{room, i, nowMs, 0};
+        link.idleTimer = timers.schedule(PLAYER_IDLE_TIMEOUT_MS, [this, socket]() { checkIdle(socket); });
+        players[socket] = link;
     }
+    rooms.push_back(room);
+    metrics.connectedClients.store(players.size(), std::memory_order_relaxed);
+    metrics.roomsActive.store(rooms.size(), std::memory_order_relaxed);
+
+    scheduler.dispatch(room);
+    std::cout << "Partie " << roomId << " démarrée, " << rooms.size() << " en cours" << std::endl;
 }
 
-int Server::getConnectedClientCount() const {
-    int count = 0;
-    for (int socket : clientSockets) {
-        if (socket >= 0) {
-            count++;
+void Server::sweepRooms() {
+    size_t kept = 0;
+    for (size_t i = 0; i < rooms.size(); i++) {
+        std::shared_ptr<Room>& room = rooms[i];
+        if (!room->isFinished()) {
+            if (kept != i) {
+                rooms[kept] = std::move(room);
+            }
+            kept++;
+            continue;
         }
+        for (int slot = 0; slot < MAX_PLAYERS; slot++) {
+            int socket = room->getSocket(slot);
+            auto link = players.find(socket);
+            if (link != players.end()) {
+                timers.cancel(link->second.idleTimer);
+                players.erase(link);
+                backend->unwatch(socket);
+            }
+        }
+        room->closeSockets();
+        if (featuredRoomId == room->getId()) {
+            featuredRoomId = -1;
+        }
+    }
+    if (kept == rooms.size()) {
+        return;
+    }
+    rooms.resize(kept);
+    if (featuredRoomId < 0 && !rooms.empty()) {
+        featuredRoomId = rooms.front()->getId();
+        rooms.front()->feature(&spectatorFeed);
     }
-    return count;
+    metrics.connectedClients.store(players.size(), std::memory_order_relaxed);
+    metrics.roomsActive.store(rooms.size(), std::memory_order_relaxed);
 }
@@ -0,0 +1,614 @@
+#include "uring.hpp"
+#include <algorithm>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace {
+
+const uint16_t BUFFER_GROUP = 0;
+
+// What a request is for, kept in the top byte of its user_data. Below it
+// come the watch generation (24 bits) and the descriptor (32 bits).
+enum RequestKind : uint64_t {
+    REQUEST_ACCEPT = 1,
+    REQUEST_WAKE,
+    REQUEST_RECV,
+    REQUEST_CANCEL,
+    REQUEST_PROVIDE
+};
+
+const uint32_t GENERATION_MASK = 0xFFFFFF;
+
+uint64_t requestTag(RequestKind kind, uint32_t generation, int fd) {
+    return (static_cast<uint64_t>(kind) << 56) | (static_cast<uint64_t>(generation & GENERATION_MASK) << 32)
+        | static_cast<uint32_t>(fd);
+}
+
+RequestKind requestKind(uint64_t tag) {
+    return static_cast<RequestKind>(tag >> 56);
+}
+
+uint32_t requestGeneration(uint64_t tag) {
+    return (tag >> 32) & GENERATION_MASK;
+}
+
+int requestFd(uint64_t tag) {
+    return static_cast<int>(static_cast<uint32_t>(tag));
+}
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags, void* arg, size_t argSize) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+int ioUringRegister(int ringFd, unsigned opcode, void* arg, unsigned argCount) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, argCount));
+}
+
+}
+
+UringRing::~UringRing() {
+    if (sqes) {
+        munmap(sqes, sqesSize);
+    }
+    if (cqRing && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    if (sqRing) {
+        munmap(sqRing, sqRingSize);
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+    }
+}
+
+bool UringRing::setup(unsigned entries, unsigned flags) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    // Multishot requests post many completions each: leave them room.
+    params.flags = IORING_SETUP_CQSIZE | flags;
+    params.cq_entries = entries * 4;
+
+    ringFd = ioUringSetup(entries, &params);
+    if (ringFd < 0) {
+        return false;
+    }
+    features = params.features;
+    if (!(features & IORING_FEAT_EXT_ARG)) {
+        errno = ENOSYS;
+        return false;
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap) {
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+    }
+
+    void* memory = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ringFd, IORING_OFF_SQ_RING);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    sqRing = memory;
+    if (singleMap) {
+        cqRing = sqRing;
+    } else {
+        memory = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            ringFd, IORING_OFF_CQ_RING);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+        cqRing = memory;
+    }
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    memory = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ringFd, IORING_OFF_SQES);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(memory);
+
+    char* sq = static_cast<char*>(sqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqeTail = submittedTail = *sqTail;
+
+    char* cq = static_cast<char*>(cqRing);
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+io_uring_sqe* UringRing::nextSqe() {
+    unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    if (sqeTail - head >= sqEntries) {
+        return nullptr;
+    }
+    unsigned index = sqeTail & sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqArray[index] = index;
+    sqeTail++;
+    return sqe;
+}
+
+int UringRing::submit(unsigned waitFor, int timeoutMs) {
+    unsigned toSubmit = sqeTail - submittedTail;
+    if (toSubmit == 0 && waitFor == 0) {
+        return 0;
+    }
+    __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    io_uring_getevents_arg arg;
+    __kernel_timespec timeout;
+    void* argPointer = nullptr;
+    size_t argSize = 0;
+    if (waitFor > 0 && timeoutMs >= 0) {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+        flags |= IORING_ENTER_EXT_ARG;
+        argPointer = &arg;
+        argSize = sizeof(arg);
+    }
+
+    int result = ioUringEnter(ringFd, toSubmit, waitFor, flags, argPointer, argSize);
+    int error = errno;
+    // Whatever the kernel took, it took from the head.
+    submittedTail = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+    return result < 0 ? -error : result;
+}
+
+void UringRing::discardUnsubmitted() {
+    sqeTail = submittedTail;
+    __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+}
+
+UringBackend::~UringBackend() {
+    if (ring.descriptor() >= 0 && !buffers.empty()) {
+        // Recvs in flight write into buffers: cancel them all and wait
+        // for the cancellation to complete before anything is freed.
+        io_uring_sqe* sqe = acquireSqe();
+        bool cancelled = false;
+        if (sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+            sqe->user_data = requestTag(REQUEST_CANCEL, 0, -1);
+        }
+        for (int attempt = 0; sqe && !cancelled && attempt < 10; attempt++) {
+            ring.submit(1, POLL_TIMEOUT);
+            ring.forEachCompletion([&](const io_uring_cqe& cqe) {
+                if (cqe.user_data == requestTag(REQUEST_CANCEL, 0, -1)) {
+                    cancelled = true;
+                }
+            });
+        }
+    }
+    if (bufferRing) {
+        munmap(bufferRing, bufferRingSize);
+    }
+}
+
+bool UringBackend::open(int listenSocket, const std::vector<int>& wakeFds) {
+    this->listenSocket = listenSocket;
+    // Only the lobby thread uses this ring: completions can wait until it
+    // asks for them instead of interrupting it for every packet. Linux 6.0
+    // does not know DEFER_TASKRUN yet and rejects it with EINVAL.
+    bool ready = ring.setup(URING_ENTRIES, IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN);
+    if (!ready && errno == EINVAL) {
+        std::cout << "io_uring sans DEFER_TASKRUN, complétions traitées dès leur arrivée" << std::endl;
+        ready = ring.setup(URING_ENTRIES, IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN);
+    }
+    if (!ready) {
+        std::cerr << "io_uring indisponible: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    buffers.resize(URING_BUFFER_COUNT * URING_BUFFER_SIZE);
+    if (!setupBufferRing()) {
+        std::cout << "Anneau de buffers indisponible, buffers fournis un par un" << std::endl;
+        provideBuffers(0, URING_BUFFER_COUNT);
+    }
+
+    if (listenSocket >= 0) {
+        armAccept();
+    }
+    for (int wakeFd : wakeFds) {
+        armWake(wakeFd);
+    }
+    return ring.submit(0) >= 0;
+}
+
+UringBackend::Connection* UringBackend::findConnection(int socket) {
+    if (socket < 0 || static_cast<size_t>(socket) >= connections.size() || connections[socket].generation == 0) {
+        return nullptr;
+    }
+    return &connections[socket];
+}
+
+void UringBackend::watch(int socket) {
+    if (static_cast<size_t>(socket) >= connections.size()) {
+        connections.resize(socket + 1);
+    }
+    Connection& connection = connections[socket];
+    connection.generation = nextGeneration++ & GENERATION_MASK;
+    if (connection.generation == 0) {
+        connection.generation = nextGeneration++ & GENERATION_MASK;
+    }
+    connection.input.clear();
+    // Enough for an unfinished packet plus a whole completion; a reused
+    // descriptor already has it.
+    connection.input.reserve(Wire::HeaderLayout::SIZE + MAX_BUFFER_SIZE + URING_BUFFER_SIZE);
+    armRecv(socket, connection.generation);
+}
+
+std::vector<char>* UringBackend::watchedInput(int socket) {
+    Connection* connection = findConnection(socket);
+    return connection ? &connection->input : nullptr;
+}
+
+// Submitted at once: the caller may close the socket next, and the
+// connection is only really closed once the ring lets go of it.
+void UringBackend::unwatch(int socket) {
+    Connection* connection = findConnection(socket);
+    if (!connection) {
+        return;
+    }
+    io_uring_sqe* sqe = acquireSqe();
+    if (sqe) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = requestTag(REQUEST_RECV, connection->generation, socket);
+        sqe->user_data = requestTag(REQUEST_CANCEL, 0, socket);
+    }
+    connection->generation = 0;
+    ring.submit(0);
+}
+
+int UringBackend::wait(int timeoutMs, std::vector<NetEvent>& events) {
+    payloads.clear();
+    size_t before = events.size();
+    if (extractUnread(events) > 0) {
+        timeoutMs = 0;
+    }
+
+    int result = ring.submit(1, timeoutMs);
+    if (result < 0 && result != -ETIME && result != -EINTR && result != -EBUSY) {
+        std::cerr << "Erreur de io_uring_enter: " << strerror(-result) << std::endl;
+        return -1;
+    }
+
+    ring.forEachCompletion([&](const io_uring_cqe& cqe) {
+        switch (requestKind(cqe.user_data)) {
+            case REQUEST_ACCEPT:
+                if (cqe.res >= 0) {
+                    NetEvent event;
+                    event.kind = NetEvent::ACCEPTED;
+                    event.socket = cqe.res;
+                    events.push_back(event);
+                } else if (cqe.res != -EAGAIN && cqe.res != -ECONNABORTED && cqe.res != -EINTR) {
+                    std::cerr << "Erreur lors de l'acceptation de la connexion: " << strerror(-cqe.res) << std::endl;
+                }
+                if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                    armAccept();
+                }
+                break;
+            case REQUEST_WAKE:
+                if (cqe.res >= 0) {
+                    NetEvent event;
+                    event.kind = NetEvent::WAKE;
+                    event.socket = requestFd(cqe.user_data);
+                    events.push_back(event);
+                }
+                if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                    armWake(requestFd(cqe.user_data));
+                }
+                break;
+            case REQUEST_RECV:
+                handleRecv(cqe, events);
+                break;
+            case REQUEST_CANCEL:
+                break;
+            case REQUEST_PROVIDE:
+                LOG_WARN("Erreur lors de la fourniture de buffers: " << strerror(-cqe.res));
+                break;
+        }
+    });
+    return events.size() - before;
+}
+
+std::unique_ptr<SendBatch> UringBackend::createSendBatch() {
+    auto batch = std::make_unique<UringSendBatch>();
+    if (!batch->setup()) {
+        std::cerr << "io_uring indisponible pour les envois: " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+    return batch;
+}
+
+io_uring_sqe* UringBackend::acquireSqe() {
+    io_uring_sqe* sqe = ring.nextSqe();
+    if (!sqe) {
+        ring.submit(0);
+        sqe = ring.nextSqe();
+    }
+    if (!sqe) {
+        LOG_WARN("File de soumission io_uring pleine");
+    }
+    return sqe;
+}
+
+void UringBackend::armAccept() {
+    io_uring_sqe* sqe = acquireSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenSocket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC | SOCK_NONBLOCK;
+    sqe->user_data = requestTag(REQUEST_ACCEPT, 0, listenSocket);
+}
+
+void UringBackend::armWake(int wakeFd) {
+    io_uring_sqe* sqe = acquireSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeFd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = requestTag(REQUEST_WAKE, 0, wakeFd);
+}
+
+void UringBackend::armRecv(int socket, uint32_t generation) {
+    io_uring_sqe* sqe = acquireSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = requestTag(REQUEST_RECV, generation, socket);
+}
+
+bool UringBackend::setupBufferRing() {
+    bufferRingSize = URING_BUFFER_COUNT * sizeof(io_uring_buf);
+    void* memory = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf_ring*>(memory);
+
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    registration.ring_entries = URING_BUFFER_COUNT;
+    registration.bgid = BUFFER_GROUP;
+    if (ioUringRegister(ring.descriptor(), IORING_REGISTER_PBUF_RING, &registration, 1) == 0) {
+        for (uint16_t bufferId = 0; bufferId < URING_BUFFER_COUNT; bufferId++) {
+            recycleBuffer(bufferId);
+        }
+        if (probeBufferRing()) {
+            return true;
+        }
+        ioUringRegister(ring.descriptor(), IORING_UNREGISTER_PBUF_RING, &registration, 1);
+    }
+    munmap(bufferRing, bufferRingSize);
+    bufferRing = nullptr;
+    return false;
+}
+
+// Some kernels accept the registration but never hand out the ring's
+// buffers: read one byte through it before relying on it.
+bool UringBackend::probeBufferRing() {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) {
+        return false;
+    }
+    bool works = false;
+    io_uring_sqe* sqe = ring.nextSqe();
+    if (sqe && send(pair[1], "", 1, MSG_NOSIGNAL) == 1) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = pair[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        if (ring.submit(1, POLL_TIMEOUT) >= 0) {
+            ring.forEachCompletion([&](const io_uring_cqe& cqe) {
+                if (cqe.flags & IORING_CQE_F_BUFFER) {
+                    recycleBuffer(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    works = cqe.res == 1;
+                }
+            });
+        }
+    }
+    close(pair[0]);
+    close(pair[1]);
+    return works;
+}
+
+// The older way to fill the group, one IORING_OP_PROVIDE_BUFFERS per
+// range. Its completion is skipped and it goes out with the next submit,
+// so it costs no system call of its own.
+void UringBackend::provideBuffers(uint16_t firstId, unsigned count) {
+    io_uring_sqe* sqe = acquireSqe();
+    if (!sqe) {
+        return;
+    }
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = count;
+    sqe->addr = reinterpret_cast<uint64_t>(buffers.data() + static_cast<size_t>(firstId) * URING_BUFFER_SIZE);
+    sqe->len = URING_BUFFER_SIZE;
+    sqe->off = firstId;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    sqe->user_data = requestTag(REQUEST_PROVIDE, 0, -1);
+}
+
+// Hands a buffer back to the kernel. Only addr, len and bid are written:
+// the ring's tail shares its memory with the first entry's reserved field.
+void UringBackend::recycleBuffer(uint16_t bufferId) {
+    if (!bufferRing) {
+        provideBuffers(bufferId, 1);
+        return;
+    }
+    uint16_t tail = bufferRing->tail;
+    io_uring_buf& buffer = bufferRing->bufs[tail & (URING_BUFFER_COUNT - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(buffers.data() + static_cast<size_t>(bufferId) * URING_BUFFER_SIZE);
+    buffer.len = URING_BUFFER_SIZE;
+    buffer.bid = bufferId;
+    __atomic_store_n(&bufferRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+void UringBackend::handleRecv(const io_uring_cqe& cqe, std::vector<NetEvent>& events) {
+    int socket = requestFd(cqe.user_data);
+    Connection* connection = findConnection(socket);
+    bool current = connection && connection->generation == requestGeneration(cqe.user_data);
+
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        uint16_t bufferId = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        if (current && cqe.res > 0) {
+            const char* data = buffers.data() + static_cast<size_t>(bufferId) * URING_BUFFER_SIZE;
+            connection->input.insert(connection->input.end(), data, data + cqe.res);
+        }
+        recycleBuffer(bufferId);
+    }
+    if (!current) {
+        return;
+    }
+
+    if (cqe.res > 0 && !extractPackets(socket, connection->input, events)) {
+        closeConnection(socket, events);
+        return;
+    }
+    if (cqe.flags & IORING_CQE_F_MORE) {
+        return;
+    }
+    // The multishot recv ended: out of buffers or a full completion queue
+    // only need it armed again, anything else means the peer is gone.
+    if (cqe.res > 0 || cqe.res == -ENOBUFS) {
+        armRecv(socket, connection->generation);
+        return;
+    }
+    if (cqe.res < 0) {
+        LOG_DEBUG("Erreur de réception, socket " << socket << ": " << strerror(-cqe.res));
+    }
+    connection->generation = 0;
+    NetEvent event;
+    event.kind = NetEvent::CLOSED;
+    event.socket = socket;
+    events.push_back(event);
+}
+
+void UringBackend::closeConnection(int socket, std::vector<NetEvent>& events) {
+    unwatch(socket);
+    NetEvent event;
+    event.kind = NetEvent::CLOSED;
+    event.socket = socket;
+    events.push_back(event);
+}
+
+void UringSendBatch::add(PeerOutput& peer) {
+    if (used == outgoing.size()) {
+        outgoing.emplace_back();
+    }
+    outgoing[used].peer = &peer;
+    outgoing[used].done = false;
+    used++;
+}
+
+void UringSendBatch::flush() {
+    bool failed = false;
+    while (!failed) {
+        unsigned submitted = 0;
+        for (size_t i = 0; i < used; i++) {
+            Outgoing& out = outgoing[i];
+            if (out.done || out.peer->backlog.empty()) {
+                continue;
+            }
+            size_t parts = out.peer->backlog.gather(out.iov, URING_MAX_IOV);
+            out.offered = 0;
+            for (size_t p = 0; p < parts; p++) {
+                out.offered += out.iov[p].iov_len;
+            }
+            std::memset(&out.message, 0, sizeof(out.message));
+            out.message.msg_iov = out.iov;
+            out.message.msg_iovlen = parts;
+
+            // A full queue leaves the rest of the peers for the next round.
+            io_uring_sqe* sqe = ring.nextSqe();
+            if (!sqe) {
+                break;
+            }
+            // Most peers have a single snapshot: a plain send is cheaper.
+            sqe->fd = out.peer->socket;
+            sqe->msg_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+            if (parts == 1) {
+                sqe->opcode = IORING_OP_SEND;
+                sqe->addr = reinterpret_cast<uint64_t>(out.iov[0].iov_base);
+                sqe->len = out.iov[0].iov_len;
+            } else {
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->addr = reinterpret_cast<uint64_t>(&out.message);
+                sqe->len = 1;
+            }
+            sqe->user_data = i;
+            submitted++;
+        }
+        if (submitted == 0) {
+            break;
+        }
+
+        unsigned completed = 0;
+        int result = ring.submit(submitted);
+        while (completed < submitted) {
+            if (result < 0 && result != -EINTR && result != -EAGAIN && result != -EBUSY) {
+                LOG_WARN("Erreur de io_uring_enter: " << strerror(-result));
+                ring.discardUnsubmitted();
+                failed = true;
+                break;
+            }
+            completed += ring.forEachCompletion([&](const io_uring_cqe& cqe) {
+                Outgoing& out = outgoing[cqe.user_data];
+                if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                    out.done = true;
+                    return;
+                }
+                if (cqe.res <= 0) {
+                    drop(*out.peer, strerror(-cqe.res));
+                    out.done = true;
+                    return;
+                }
+                out.peer->backlog.consume(cqe.res, out.peer->counters);
+                // A short send means the socket buffer is full.
+                if (static_cast<size_t>(cqe.res) < out.offered) {
+                    out.done = true;
+                }
+            });
+            if (completed < submitted) {
+                result = ring.submit(submitted - completed);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < used; i++) {
+        outgoing[i].peer->batched = false;
+    }
+    used = 0;
+}